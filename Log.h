@@ -0,0 +1,232 @@
+#pragma once
+
+#include "MyFt.h"
+
+// 异步访问日志
+// 每个线程往自己的单生产者单消费者环形缓冲区里放定长的事件记录，不加锁；
+// 后台写线程轮流取出各个缓冲区里的事件，格式化成文本或者直接写二进制记录
+
+// 日志级别：OFF 不记录；FAULTS 只记录缺页、置换和作业的分配释放；ALL 还记录每一次访问
+enum class LogLevel { OFF, FAULTS, ALL };
+
+enum class LogEventType : uint8_t {
+    ACCESS, // 访问内存
+    FAULT, // 缺页中断
+    REPLACE, // 页面置换
+    WAIT, // 作业等待内存
+    ALLOCATE, // 作业分配到内存
+    FREE, // 作业释放内存
+    SUSPEND, // 作业被挂起，让出内存
+};
+
+// 一条事件记录，二进制日志中原样写出
+struct LogEvent {
+    uint8_t type; // LogEventType
+    uint8_t write; // 是否是写操作
+    uint16_t reserved;
+    int32_t job_id;
+    int32_t address; // 逻辑地址
+    int32_t page; // 虚拟页面号
+    int32_t frame; // 物理页框号
+    int32_t content_job; // 页框中页面的内容 <作业号, 页面号>；置换时是被换出的页面
+    int32_t content_page;
+    int32_t count; // 分配、释放的页面数
+};
+static_assert(sizeof(LogEvent) == 32, "LogEvent is written to binary logs as is");
+
+const char LOG_MAGIC[8] = {'M', 'F', 'T', 'L', 'O', 'G', '0', '1'}; // 二进制日志的文件头
+const int LOG_RING_SIZE = 1 << 12; // 每个线程的环形缓冲区能放的事件数，2 的幂
+
+class Logger {
+private:
+    // 单生产者单消费者环形缓冲区
+    struct Ring {
+        LogEvent events[LOG_RING_SIZE];
+        atomic<size_t> head{0}; // 写线程下一个要取的位置
+        atomic<size_t> tail{0}; // 生产者下一个要放的位置
+    };
+
+    LogLevel level;
+    uint64_t id; // 每个 Logger 不同，线程据此找到自己在这个 Logger 里的缓冲区
+    FILE* out;
+    bool binary;
+    bool owns_file; // out 是 Logger 自己打开的
+    vector<unique_ptr<Ring>> rings; // 每个写过日志的线程一个
+    mutex rings_mtx; // 保护 rings，生产者只在第一次写日志、注册缓冲区时使用
+    atomic<bool> stop{false};
+    thread writer;
+public:
+    // path 为空时写到标准输出
+    Logger(LogLevel level, const string& path = "", bool binary = false) : level(level), binary(binary) {
+        static atomic<uint64_t> next_id{1};
+        id = next_id++;
+        out = path.empty() ? stdout : fopen(path.c_str(), binary ? "wb" : "w");
+        owns_file = !path.empty() && out;
+        if (!out) {
+            cerr << "Failed to open log file " << path << endl;
+            this->level = LogLevel::OFF;
+            return;
+        }
+        if (binary) {
+            fwrite(LOG_MAGIC, sizeof(LOG_MAGIC), 1, out);
+        }
+        if (this->level != LogLevel::OFF) {
+            writer = thread(&Logger::drain_loop, this);
+        }
+    }
+
+    // 写完缓冲区里剩下的事件再退出
+    ~Logger() {
+        stop = true;
+        if (writer.joinable()) {
+            writer.join();
+        }
+        if (out) {
+            fflush(out);
+        }
+        if (owns_file) {
+            fclose(out);
+        }
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    bool enabled(LogEventType type) const {
+        if (type == LogEventType::ACCESS) {
+            return level == LogLevel::ALL;
+        }
+        return level != LogLevel::OFF;
+    }
+
+    void log(const LogEvent& event) {
+        if (!enabled((LogEventType)event.type)) {
+            return;
+        }
+        Ring* ring = local_ring();
+        size_t tail = ring->tail.load(memory_order_relaxed);
+        while (tail - ring->head.load(memory_order_acquire) == LOG_RING_SIZE) { // 满了等写线程取走，不丢日志
+            this_thread::yield();
+        }
+        ring->events[tail & (LOG_RING_SIZE - 1)] = event;
+        ring->tail.store(tail + 1, memory_order_release);
+    }
+
+    static bool parse_level(const string& name, LogLevel& level) {
+        if (name == "off") {
+            level = LogLevel::OFF;
+        }
+        else if (name == "faults") {
+            level = LogLevel::FAULTS;
+        }
+        else if (name == "all") {
+            level = LogLevel::ALL;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // 当前线程在这个 Logger 里的缓冲区，第一次写日志时注册
+    Ring* local_ring() {
+        static thread_local uint64_t owner = 0;
+        static thread_local Ring* ring = nullptr;
+        if (owner != id) {
+            lock_guard<mutex> lock(rings_mtx);
+            rings.push_back(unique_ptr<Ring>(new Ring()));
+            ring = rings.back().get();
+            owner = id;
+        }
+        return ring;
+    }
+
+    void drain_loop() {
+        vector<char> text; // 一批文本一起写出
+        for (;;) {
+            bool stopping = stop.load(); // 先读停止标志再取事件，保证停止前放入的事件都被写出
+            size_t drained = 0;
+            {
+                lock_guard<mutex> lock(rings_mtx);
+                for (int i = 0; i < rings.size(); i++) {
+                    drained += drain(*rings[i], text);
+                }
+            }
+            if (!text.empty()) {
+                fwrite(text.data(), 1, text.size(), out);
+                text.clear();
+            }
+            if (stopping && drained == 0) {
+                return;
+            }
+            if (drained == 0) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+    }
+
+    size_t drain(Ring& ring, vector<char>& text) {
+        size_t head = ring.head.load(memory_order_relaxed);
+        size_t tail = ring.tail.load(memory_order_acquire);
+        for (size_t i = head; i < tail; i++) {
+            const LogEvent& event = ring.events[i & (LOG_RING_SIZE - 1)];
+            if (binary) {
+                fwrite(&event, sizeof(event), 1, out);
+            }
+            else {
+                format(event, text);
+            }
+        }
+        ring.head.store(tail, memory_order_release);
+        return tail - head;
+    }
+
+    // 文本格式和原来直接输出到 cout 的信息一致
+    static void format(const LogEvent& e, vector<char>& text) {
+        char line[256];
+        int n = 0;
+        switch ((LogEventType)e.type) {
+        case LogEventType::ACCESS:
+            n = snprintf(line, sizeof(line), "Job %d accesses address %d, which is page <%d, %d>, at physical address %d\n",
+                e.job_id, e.address, e.content_job, e.content_page, e.frame * PAGE_SIZE + e.address % PAGE_SIZE);
+            break;
+        case LogEventType::FAULT:
+            n = snprintf(line, sizeof(line), "Page fault occurs when job %d accesses address %d\n", e.job_id, e.address);
+            break;
+        case LogEventType::REPLACE:
+            n = snprintf(line, sizeof(line), "Page <%d, %d> in frame %d is replaced by page <%d, %d>\n",
+                e.content_job, e.content_page, e.frame, e.job_id, e.page);
+            break;
+        case LogEventType::WAIT:
+            n = snprintf(line, sizeof(line), "Job %d is waiting for memory resources.\n", e.job_id);
+            break;
+        case LogEventType::ALLOCATE:
+            n = snprintf(line, sizeof(line), "Job %d has been allocated %d pages.\n", e.job_id, e.count);
+            break;
+        case LogEventType::FREE:
+            n = snprintf(line, sizeof(line), "Job %d has freed %d pages.\n", e.job_id, e.count);
+            break;
+        case LogEventType::SUSPEND:
+            n = snprintf(line, sizeof(line), "Job %d is thrashing and has been suspended, releasing %d pages.\n", e.job_id, e.count);
+            break;
+        }
+        text.insert(text.end(), line, line + min(n, (int)sizeof(line) - 1));
+    }
+};
+
+// 工作线程往终端输出一行：先格式化到局部缓冲区，再加锁整行一次写出，几个线程的输出不会拼在一行里
+// cout 和 stdio 同步，一次 write 就是对 stdout 的一次 fwrite，和日志线程写到标准输出的 fwrite 也不会交错
+inline void print_line(const char* format, ...) {
+    static mutex print_mtx;
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line) - 1, format, args); // 留一个字节放换行
+    va_end(args);
+    n = min(max(n, 0), (int)sizeof(line) - 2); // 太长的行截断
+    line[n] = '\n';
+    lock_guard<mutex> lock(print_mtx);
+    cout.write(line, n + 1);
+    cout.flush();
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "MyFt.h"
+
+// 缺页率曲线 (miss ratio curve)
+// LRU 满足包含性：c 个页框时命中的访问在 c+1 个页框时也命中，所以一次访问在 c 个页框下缺页当且仅当它的栈距离大于 c
+// 栈距离是上一次访问同一页面以来访问过的不同页面数（包括自己）。扫一遍访问序列得到栈距离的直方图，
+// 就能得到所有页框数下的缺页次数
+
+// 树状数组：位置上的 0/1 标记，求前缀和
+class FenwickTree {
+private:
+    vector<int> tree; // 下标从 1 开始
+public:
+    FenwickTree(int size = 0) : tree(size + 1, 0) {}
+
+    int size() const {
+        return tree.size() - 1;
+    }
+
+    // 位置 [0, i) 上的和
+    int count(int i) const {
+        int s = 0;
+        for (; i > 0; i -= i & -i) {
+            s += tree[i];
+        }
+        return s;
+    }
+
+    void add(int i, int v) {
+        for (i++; i < tree.size(); i += i & -i) {
+            tree[i] += v;
+        }
+    }
+
+    // 清空后在 [0, k) 上都记 1，O(size)
+    void reset_ones(int k) {
+        fill(tree.begin(), tree.end(), 0);
+        for (int i = 1; i < tree.size(); i++) {
+            tree[i] += i <= k;
+            int parent = i + (i & -i);
+            if (parent < tree.size()) {
+                tree[parent] += tree[i];
+            }
+        }
+    }
+};
+
+// Mattson 栈距离，用树状数组求：每个页面只在最近一次被访问的位置上记 1，
+// 两次访问同一页面之间的不同页面数就是这两个位置之间的 1 的个数，每次访问 O(log n)
+class StackDistances {
+private:
+    FenwickTree tree;
+    vector<int> last; // 每个页面最近一次被访问的位置，没访问过是 -1
+    vector<int> page_at; // 每个位置上记着 1 的页面，-1 表示没有
+    int now = 0; // 下一次访问的位置
+    vector<long long> hist; // hist[d] 是栈距离为 d 的访问次数
+    long long cold = 0; // 第一次访问某个页面的次数，页框再多也要缺页
+    long long total = 0;
+public:
+    // keys 是页面号的范围 [0, keys)
+    StackDistances(int keys) : last(keys, -1) {
+        int capacity = max(2 * keys, 1024);
+        tree = FenwickTree(capacity);
+        page_at.assign(capacity, -1);
+        hist.assign(keys + 1, 0);
+    }
+
+    void access(int page) {
+        if (now == page_at.size()) {
+            compact();
+        }
+        total++;
+        int p = last[page];
+        if (p == -1) {
+            cold++;
+        }
+        else {
+            hist[tree.count(now) - tree.count(p + 1) + 1]++; // (p, now) 之间不同的页面数，加上自己
+            tree.add(p, -1);
+            page_at[p] = -1;
+        }
+        tree.add(now, 1);
+        page_at[now] = page;
+        last[page] = now++;
+    }
+
+    long long accesses() const {
+        return total;
+    }
+
+    // 访问过的不同页面数，页框数超过它以后缺页次数不再变化
+    long long distinct() const {
+        return cold;
+    }
+
+    // frames 个页框时 LRU 的缺页次数，包括第一次访问的缺页
+    long long misses(int frames) const {
+        long long m = cold;
+        for (int d = frames + 1; d < hist.size(); d++) {
+            m += hist[d];
+        }
+        return m;
+    }
+
+    // 1..max_frames 个页框时的缺页次数，下标 c 对应 c 个页框，下标 0 是访问总数
+    vector<long long> curve(int max_frames) const {
+        vector<long long> out(max_frames + 1);
+        out[0] = total;
+        long long m = cold;
+        for (int d = hist.size() - 1; d > max_frames; d--) {
+            m += hist[d];
+        }
+        for (int c = max_frames; c >= 1; c--) { // 从大到小累加，整条曲线 O(N)
+            out[c] = m;
+            if (c < hist.size()) {
+                m += hist[c];
+            }
+        }
+        return out;
+    }
+
+private:
+    // 位置用完了：只有每个页面最近一次访问的位置有用，按原来的顺序重新编号，树状数组重建
+    void compact() {
+        int k = 0;
+        for (int i = 0; i < page_at.size(); i++) {
+            if (page_at[i] != -1) {
+                page_at[k] = page_at[i];
+                last[page_at[k]] = k;
+                k++;
+            }
+        }
+        fill(page_at.begin() + k, page_at.end(), -1);
+        tree.reset_ones(k);
+        now = k;
+    }
+};
+
+// SHARDS 抽样的缺页率曲线，给页面数和访问数都很大的轨迹用
+// 页面号哈希到 [0, SHARDS_MODULUS)，小于阈值 T 的页面才被抽中，抽样率 R = T / SHARDS_MODULUS；
+// 抽中页面的访问照常求栈距离，距离除以 R 就是原轨迹中的估计值。按页面而不是按访问抽样，同一页面的访问要么全抽中要么全不抽中
+// 抽中的页面超过 max_pages 个时降低阈值，把哈希值最大的页面去掉，已有的计数按 R 的变化比例缩小，内存用量固定
+// 最后按 SHARDS-adj 用期望的抽样访问数 N * R 作分母，修正抽样访问数的偏差
+const uint64_t SHARDS_MODULUS = 1 << 24;
+const int SHARDS_BUCKETS = 1024; // 栈距离直方图的桶数，距离超出范围时桶宽加倍，两两合并
+const int SHARDS_MAX_PAGES = 8192; // 默认最多同时跟踪的抽样页面数
+const int SHARDS_POINTS = 256; // 输出曲线上的页框数个数
+
+class ShardsMrc {
+private:
+    uint64_t threshold; // 阈值 T
+    size_t max_pages;
+    FenwickTree tree;
+    vector<long long> page_at; // 每个位置上记着 1 的页面，-1 表示没有
+    unordered_map<long long, int> last; // 抽中的页面最近一次被访问的位置
+    set<pair<uint64_t, long long>> by_hash; // 抽中的页面按哈希值排序，降低阈值时从大的一端去掉
+    int now = 0;
+    vector<double> hist; // 第 i 个桶是估计栈距离减 1 在 [i * width, (i + 1) * width) 中的抽样访问数
+    double width = 1;
+    double cold = 0; // 第一次访问的抽样访问数
+    double sampled = 0; // 抽样访问数，按抽样率的变化缩放过
+    long long total = 0; // 原轨迹的访问数
+public:
+    ShardsMrc(double rate, size_t max_pages = SHARDS_MAX_PAGES)
+        : threshold(max((uint64_t)1, (uint64_t)(min(max(rate, 0.0), 1.0) * SHARDS_MODULUS))), max_pages(max(max_pages, (size_t)1)),
+          tree(2 * max_pages + 1024), page_at(2 * max_pages + 1024, -1), hist(SHARDS_BUCKETS, 0) {}
+
+    void access(long long page) {
+        total++;
+        uint64_t h = hash(page) % SHARDS_MODULUS;
+        if (h >= threshold) {
+            return;
+        }
+        if (now == page_at.size()) {
+            compact();
+        }
+        sampled++;
+        auto it = last.find(page);
+        if (it == last.end()) {
+            cold++;
+            by_hash.insert(make_pair(h, page));
+        }
+        else {
+            int p = it->second;
+            add_distance((tree.count(now) - tree.count(p + 1) + 1) / rate() - 1); // 减 1，距离正好是页框数的访问落在桶的右侧，算命中
+            tree.add(p, -1);
+            page_at[p] = -1;
+        }
+        tree.add(now, 1);
+        page_at[now] = page;
+        last[page] = now++;
+        if (last.size() > max_pages) {
+            lower_threshold();
+        }
+    }
+
+    double rate() const {
+        return (double)threshold / SHARDS_MODULUS;
+    }
+
+    long long accesses() const {
+        return total;
+    }
+
+    double sampled_accesses() const {
+        return sampled;
+    }
+
+    size_t sampled_pages() const {
+        return last.size();
+    }
+
+    // 估计栈距离的最大值，页框数超过它以后缺页率不再变化
+    long long max_distance() const {
+        int i = hist.size() - 1;
+        while (i > 0 && hist[i] == 0) {
+            i--;
+        }
+        return (long long)ceil((i + 1) * width);
+    }
+
+    // 曲线的分辨率：抽中的页面之间隔着大约 1/R 个页面，桶宽也限制了精度，页框数比它小的点不可靠
+    double resolution() const {
+        return max(1 / rate(), width);
+    }
+
+    // frames 个页框时 LRU 的估计缺页率，距离大于 frames 的访问缺页；桶中的访问按距离在桶内均匀分布算
+    // 抽样率为 1 时桶宽是 1，结果和 StackDistances 的精确曲线一样
+    double miss_ratio(long long frames) const {
+        double expected = total * rate(); // SHARDS-adj：抽样访问数的期望值
+        if (expected <= 0) {
+            return 0;
+        }
+        double misses = cold;
+        for (int i = 0; i < hist.size(); i++) {
+            double beyond = ((i + 1) * width - frames) / width; // 桶中距离减 1 不小于 frames 的比例
+            misses += hist[i] * min(max(beyond, 0.0), 1.0);
+        }
+        return min(misses / expected, 1.0);
+    }
+
+    // 缺页率估计值的标准误差，把抽样访问当作独立的伯努利试验，只是粗略的误差量级
+    double std_error(long long frames) const {
+        double p = miss_ratio(frames);
+        return sqrt(p * (1 - p) / max(sampled, 1.0));
+    }
+
+private:
+    static uint64_t hash(long long page) { // splitmix64 的混合函数
+        uint64_t z = (uint64_t)page + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    void add_distance(double d) {
+        while (d >= hist.size() * width) { // 超出范围，桶宽加倍
+            for (int i = 0; i < hist.size() / 2; i++) {
+                hist[i] = hist[2 * i] + hist[2 * i + 1];
+            }
+            fill(hist.begin() + hist.size() / 2, hist.end(), 0);
+            width *= 2;
+        }
+        hist[(int)(d / width)]++;
+    }
+
+    // 阈值降到最大的哈希值，去掉哈希值不小于它的页面，已有的计数按抽样率的变化缩小
+    void lower_threshold() {
+        uint64_t t = by_hash.rbegin()->first;
+        while (!by_hash.empty() && by_hash.rbegin()->first >= t) {
+            long long page = by_hash.rbegin()->second;
+            by_hash.erase(prev(by_hash.end()));
+            int p = last[page];
+            tree.add(p, -1);
+            page_at[p] = -1;
+            last.erase(page);
+        }
+        double scale = (double)t / threshold;
+        for (int i = 0; i < hist.size(); i++) {
+            hist[i] *= scale;
+        }
+        cold *= scale;
+        sampled *= scale;
+        threshold = t;
+    }
+
+    // 位置用完了，只保留每个页面最近一次访问的位置，按原来的顺序重新编号
+    void compact() {
+        int k = 0;
+        for (int i = 0; i < page_at.size(); i++) {
+            if (page_at[i] != -1) {
+                page_at[k] = page_at[i];
+                last[page_at[k]] = k;
+                k++;
+            }
+        }
+        fill(page_at.begin() + k, page_at.end(), -1);
+        tree.reset_ones(k);
+        now = k;
+    }
+};
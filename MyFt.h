@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <iomanip>
 #include <vector>
 #include <random>
 #include <thread>
@@ -8,9 +9,25 @@
 #include <fstream>
 #include <string>
 #include <unordered_map>
+#include <map>
+#include <set>
 #include <cmath>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <queue>
+#include <deque>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <cstdarg>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 using namespace std;
 
 // 定义常量
@@ -20,11 +37,22 @@ const int PAGE_ENTRY_SIZE = 4; // 每个页表项的大小，4 字节
 const int PHYSICAL_PAGE_NUM = 1 << 6; // 系统的物理页面数，2^6
 const int VIRTUAL_PAGE_NUM = 1 << 8; // 每个进程的虚拟页面数，2^8
 const int PROCESS_PAGE_NUM = 9; // 每个进程分配的页面数，9
+const int MIN_PROCESS_PAGE_NUM = 3; // 动态分配时每个进程至少的页面数，也是刚准入时的页面数
+const int MAX_PROCESS_PAGE_NUM = 32; // 动态分配时每个进程至多的页面数
+const int WS_WINDOW = 50; // 工作集窗口 Δ，按访问次数计
+const int PFF_GROW_INTERVAL = 10; // 两次缺页之间的访问次数少于它时扩大常驻集合
+const int PFF_SHRINK_INTERVAL = 50; // 多于它时缩小常驻集合
+const int SUSPEND_AFTER = 4; // 连续这么多次想扩大常驻集合却拿不到页框，就挂起作业让出内存
 const int PROCESS_NUM = 12; // 进程的数量，12
 const int ACCESS_NUM = 200; // 每个进程的访问次数，200
+const int WRITE_PERCENT = 25; // 写操作占访问的百分比，25%
 const int MAX_SLEEP_TIME = 100; // 每次访问后的最大休眠时间，100 ms
+const int DISK_IO_TIME = 10; // 虚拟时间模式下读写一个页面的时间，10 ms
 const string FILE_PREFIX = "file_"; // 文件的前缀，file_
 const string FILE_SUFFIX = ".txt"; // 文件的后缀，.txt
+const string BINARY_FILE_SUFFIX = ".bin"; // 二进制文件的后缀，.bin
+const int TEXT_RECORD_SIZE = 32; // 文本文件每行的长度（含换行），定长才能原地改写
+const uint32_t PAGE_MAGIC = 0x50474654; // 二进制页面记录的标记，"TFGP"
 
 
 
@@ -0,0 +1,1129 @@
+#pragma once
+
+#include "MyFt.h"
+
+// 页面替换算法
+// 每个算法是一个满足 ReplacementPolicy 约定的类，Process 以它为模板参数，访问路径上的调用都是静态分派、可以内联的:
+//   static const char* name();                         算法名，和命令行参数一致
+//   Policy(int capacity, int keys);                    capacity 个页框，页面号在 [0, keys) 之间
+//   void reset(int capacity, int keys);                回到刚构造时的状态，已有的缓冲区原地复用，不重新分配
+//   void prepare(const vector<int>& pages);            开始访问前传入整个访问序列（只有 OPT 用得到）
+//   void on_preload(int page, int slot);               开始访问之前把 page 预先装入 slot 号槽位
+//   void on_load(int page, int slot);                  缺页时 page 装入了 slot 号槽位
+//   void on_access(int page, int slot);                命中 slot 号槽位中的 page
+//   int choose_victim(int page, const ResidentSet&);   页框已满时为缺页的 page 选出要淘汰的槽位
+//   void on_remove(int page, int slot);                page 不经过 choose_victim 被移出 slot 号槽位（缩小常驻集合、挂起）
+//   void on_move(int page, int from, int to);          page 从 from 号槽位挪到 to 号槽位，在算法中的次序不变
+//   void resize(int capacity);                         槽位数变成 capacity，缩小时多出来的槽位已经空了
+// 常驻集合变大变小时只用后三个调用告诉算法，影子链表、ARC 的 p、FIFO 的顺序、CLOCK 的访问位都保留
+
+// 进程的常驻集合，替换算法选淘汰对象时可以查看
+struct ResidentSet {
+    vector<int> frames; // 分配给进程的页框，下标是槽位
+    vector<int> page_slot; // 虚拟页面所在的槽位，不在内存为 -1
+    vector<char> dirty; // 槽位中的页面装入后是否被写过
+};
+
+// LRU 链表：以进程的页框槽位为结点的侵入式双向链表，表头最近使用，表尾最久未使用
+// 访问和淘汰都是 O(1)
+class LruList {
+private:
+    vector<int> prev, next; // 按槽位下标，-1 表示没有
+    vector<char> linked; // 槽位是否在链表中
+    int head = -1, tail = -1;
+public:
+    LruList(int capacity = 0) {
+        reset(capacity);
+    }
+
+    void reset(int capacity) {
+        prev.assign(capacity, -1);
+        next.assign(capacity, -1);
+        linked.assign(capacity, 0);
+        head = tail = -1;
+    }
+
+    // 槽位数变成 capacity，缩小时去掉的槽位已经不在链表中
+    void resize(int capacity) {
+        prev.resize(capacity, -1);
+        next.resize(capacity, -1);
+        linked.resize(capacity, 0);
+    }
+
+    // 把槽位移到表头，不在链表中就插入
+    void touch(int slot) {
+        if (slot >= linked.size()) {
+            resize(slot + 1);
+        }
+        if (linked[slot]) {
+            if (head == slot) {
+                return;
+            }
+            unlink(slot);
+        }
+        prev[slot] = -1;
+        next[slot] = head;
+        if (head != -1) {
+            prev[head] = slot;
+        }
+        head = slot;
+        if (tail == -1) {
+            tail = slot;
+        }
+        linked[slot] = 1;
+    }
+
+    // 取出最久未使用的槽位，链表为空返回 -1
+    int evict() {
+        int slot = tail;
+        if (slot != -1) {
+            unlink(slot);
+        }
+        return slot;
+    }
+
+    void remove(int slot) {
+        if (slot < linked.size() && linked[slot]) {
+            unlink(slot);
+        }
+    }
+
+    // 空槽位 to 接替 from 在链表中的位置
+    void move(int from, int to) {
+        if (from >= linked.size() || !linked[from]) {
+            return;
+        }
+        if (to >= linked.size()) {
+            resize(to + 1);
+        }
+        prev[to] = prev[from];
+        next[to] = next[from];
+        if (prev[to] != -1) {
+            next[prev[to]] = to;
+        }
+        else {
+            head = to;
+        }
+        if (next[to] != -1) {
+            prev[next[to]] = to;
+        }
+        else {
+            tail = to;
+        }
+        linked[to] = 1;
+        prev[from] = next[from] = -1;
+        linked[from] = 0;
+    }
+
+private:
+    void unlink(int slot) {
+        if (prev[slot] != -1) {
+            next[prev[slot]] = next[slot];
+        }
+        else {
+            head = next[slot];
+        }
+        if (next[slot] != -1) {
+            prev[next[slot]] = prev[slot];
+        }
+        else {
+            tail = prev[slot];
+        }
+        prev[slot] = next[slot] = -1;
+        linked[slot] = 0;
+    }
+};
+
+// CLOCK（第二次机会）：槽位排成一圈，每个槽位一个访问位，指针扫过访问位为 1 的槽位时清零跳过
+// 增强 CLOCK 再结合修改位，优先淘汰 (未访问, 未修改)，其次 (未访问, 已修改)
+class Clock {
+private:
+    vector<char> referenced; // 按槽位下标的访问位
+    int hand = 0; // 时钟指针
+public:
+    Clock(int capacity = 0) {
+        reset(capacity);
+    }
+
+    void reset(int capacity) {
+        referenced.assign(capacity, 0);
+        hand = 0;
+    }
+
+    // 槽位数变成 capacity，新槽位的访问位为 0
+    void resize(int capacity) {
+        referenced.resize(capacity, 0);
+        if (hand >= capacity) {
+            hand = 0;
+        }
+    }
+
+    // 槽位中的页面被移走，清掉访问位
+    void clear(int slot) {
+        if (slot < referenced.size()) {
+            referenced[slot] = 0;
+        }
+    }
+
+    // 页面挪到空槽位 to，访问位跟着走
+    void move(int from, int to) {
+        if (to >= referenced.size()) {
+            referenced.resize(to + 1, 0);
+        }
+        referenced[to] = referenced[from];
+        referenced[from] = 0;
+    }
+
+    // 装入或访问槽位时置访问位
+    void reference(int slot) {
+        if (slot >= referenced.size()) {
+            referenced.resize(slot + 1, 0);
+        }
+        referenced[slot] = 1;
+    }
+
+    // 第二次机会：返回第一个访问位为 0 的槽位，指针停在它后面
+    int evict() {
+        for (;;) {
+            int slot = advance();
+            if (!referenced[slot]) {
+                return slot;
+            }
+            referenced[slot] = 0;
+        }
+    }
+
+    // 增强 CLOCK：第一圈找 (0,0) 不改访问位；第二圈找 (0,1)，同时清掉经过的访问位；再不行就重复
+    int evict_enhanced(const vector<char>& dirty) {
+        int n = referenced.size();
+        for (;;) {
+            for (int i = 0; i < n; i++) {
+                int slot = advance();
+                if (!referenced[slot] && !dirty[slot]) {
+                    return slot;
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                int slot = advance();
+                if (!referenced[slot] && dirty[slot]) {
+                    return slot;
+                }
+                referenced[slot] = 0;
+            }
+        }
+    }
+
+private:
+    int advance() {
+        int slot = hand;
+        hand = (hand + 1) % referenced.size();
+        return slot;
+    }
+};
+
+// 一组以页面号为结点的侵入式双向链表，每个页面同一时刻最多在其中一个链表里
+// 表头是最近放入的页面，表尾是最早的页面；插入、删除、移动都是 O(1)
+// ARC、2Q、LIRS 的常驻链表和影子链表（只记页面号，不占页框）都用它
+class KeyLists {
+private:
+    vector<int> prev, next; // 按页面号下标，-1 表示没有
+    vector<int> owner; // 页面所在的链表，-1 表示不在任何链表中
+    vector<int> heads, tails, sizes; // 按链表下标
+public:
+    KeyLists(int keys = 0, int lists = 0) {
+        reset(keys, lists);
+    }
+
+    void reset(int keys, int lists) {
+        prev.assign(keys, -1);
+        next.assign(keys, -1);
+        owner.assign(keys, -1);
+        heads.assign(lists, -1);
+        tails.assign(lists, -1);
+        sizes.assign(lists, 0);
+    }
+
+    int list_of(int key) const {
+        return owner[key];
+    }
+
+    int size(int list) const {
+        return sizes[list];
+    }
+
+    // 链表中最早放入的页面，链表为空返回 -1
+    int back(int list) const {
+        return tails[list];
+    }
+
+    // 放到链表头，原来在某个链表中就先移出
+    void push_front(int list, int key) {
+        if (owner[key] != -1) {
+            remove(key);
+        }
+        prev[key] = -1;
+        next[key] = heads[list];
+        if (heads[list] != -1) {
+            prev[heads[list]] = key;
+        }
+        else {
+            tails[list] = key;
+        }
+        heads[list] = key;
+        owner[key] = list;
+        sizes[list]++;
+    }
+
+    void remove(int key) {
+        int list = owner[key];
+        if (list == -1) {
+            return;
+        }
+        if (prev[key] != -1) {
+            next[prev[key]] = next[key];
+        }
+        else {
+            heads[list] = next[key];
+        }
+        if (next[key] != -1) {
+            prev[next[key]] = prev[key];
+        }
+        else {
+            tails[list] = prev[key];
+        }
+        prev[key] = next[key] = -1;
+        owner[key] = -1;
+        sizes[list]--;
+    }
+
+    // 取出链表尾，链表为空返回 -1
+    int pop_back(int list) {
+        int key = tails[list];
+        if (key != -1) {
+            remove(key);
+        }
+        return key;
+    }
+};
+
+// ARC（自适应替换）：T1 存只访问过一次的页面，T2 存访问过多次的页面，B1、B2 是它们的影子链表
+// 在 B1 中缺页说明 T1 太小，在 B2 中缺页说明 T2 太小，据此调整 T1 的目标大小 p
+class Arc {
+private:
+    enum { T1, T2, B1, B2 };
+    KeyLists lists;
+    int capacity; // 页框数 c
+    double p = 0; // T1 的目标大小
+    bool adapted = false; // 本次缺页是否已经调整过 p
+public:
+    Arc(int capacity = 0, int keys = 0) {
+        reset(capacity, keys);
+    }
+
+    void reset(int capacity, int keys) {
+        lists.reset(keys, 4);
+        this->capacity = capacity;
+        p = 0;
+        adapted = false;
+    }
+
+    // 页框数变了，p 不超过新的 c，目录超出的部分从影子链表尾去掉
+    void resize(int capacity) {
+        this->capacity = capacity;
+        p = min(p, (double)capacity);
+        trim();
+    }
+
+    // 命中 T1 或 T2，移到 T2 表头
+    void access(int page) {
+        lists.push_front(T2, page);
+    }
+
+    // 页框已满时为缺页的 page 选出被淘汰的页面
+    int evict(int page) {
+        adapt(page);
+        int where = lists.list_of(page);
+        if (where != B1 && where != B2) { // 全新的页面，先保证目录不超过 2c
+            if (lists.size(T1) + lists.size(B1) >= capacity) {
+                if (lists.size(T1) < capacity) {
+                    lists.pop_back(B1);
+                }
+                else {
+                    return lists.pop_back(T1); // B1 为空，直接淘汰 T1 的表尾，不留影子
+                }
+            }
+            else if (total() >= 2 * capacity) {
+                lists.pop_back(B2);
+            }
+        }
+        return replace(where == B2);
+    }
+
+    // page 装入页框后调用
+    void load(int page) {
+        adapt(page);
+        adapted = false;
+        int where = lists.list_of(page);
+        if (where == B1 || where == B2) { // 影子命中，说明会被再次访问
+            lists.push_front(T2, page);
+            return;
+        }
+        if (lists.size(T1) + lists.size(B1) >= capacity && lists.size(B1) > 0) { // 没有淘汰时也要限制目录大小
+            lists.pop_back(B1);
+        }
+        else if (total() >= 2 * capacity && lists.size(B2) > 0) {
+            lists.pop_back(B2);
+        }
+        lists.push_front(T1, page);
+    }
+
+    // page 不经过 evict 离开页框，和被淘汰一样在对应的影子链表里留下页面号
+    void remove(int page) {
+        int where = lists.list_of(page);
+        if (where == T1) {
+            lists.push_front(B1, page);
+        }
+        else if (where == T2) {
+            lists.push_front(B2, page);
+        }
+        trim();
+    }
+
+private:
+    int total() const {
+        return lists.size(T1) + lists.size(T2) + lists.size(B1) + lists.size(B2);
+    }
+
+    // 保证 |T1| + |B1| <= c，整个目录不超过 2c
+    void trim() {
+        while (lists.size(T1) + lists.size(B1) > capacity && lists.size(B1) > 0) {
+            lists.pop_back(B1);
+        }
+        while (total() > 2 * capacity && lists.size(B2) > 0) {
+            lists.pop_back(B2);
+        }
+    }
+
+    void adapt(int page) {
+        if (adapted) {
+            return;
+        }
+        adapted = true;
+        int where = lists.list_of(page);
+        if (where == B1) {
+            p = min((double)capacity, p + max(1.0, (double)lists.size(B2) / lists.size(B1)));
+        }
+        else if (where == B2) {
+            p = max(0.0, p - max(1.0, (double)lists.size(B1) / lists.size(B2)));
+        }
+    }
+
+    // T1 超过目标大小就淘汰 T1 的表尾进 B1，否则淘汰 T2 的表尾进 B2
+    int replace(bool in_b2) {
+        int t1 = lists.size(T1);
+        if (t1 >= 1 && ((in_b2 && t1 == (int)p) || t1 > p || lists.size(T2) == 0)) {
+            int victim = lists.back(T1);
+            lists.push_front(B1, victim);
+            return victim;
+        }
+        int victim = lists.back(T2);
+        lists.push_front(B2, victim);
+        return victim;
+    }
+};
+
+// 2Q：新页面先进 FIFO 队列 A1in，被挤出后只在影子队列 A1out 留下页面号
+// 在 A1out 中时再次缺页才进入 LRU 链表 Am，只扫描一次的页面进不了 Am
+class TwoQ {
+private:
+    enum { AM, A1IN, A1OUT };
+    KeyLists lists;
+    int kin; // A1in 的大小，c/4
+    int kout; // A1out 的大小，c/2
+public:
+    TwoQ(int capacity = 0, int keys = 0) {
+        reset(capacity, keys);
+    }
+
+    void reset(int capacity, int keys) {
+        lists.reset(keys, 3);
+        resize(capacity);
+    }
+
+    // A1in、A1out 的大小随页框数变化，A1out 超出的部分从表尾去掉
+    void resize(int capacity) {
+        kin = max(1, capacity / 4);
+        kout = max(1, capacity / 2);
+        trim();
+    }
+
+    // A1in 中的页面命中时不调整顺序
+    void access(int page) {
+        if (lists.list_of(page) == AM) {
+            lists.push_front(AM, page);
+        }
+    }
+
+    int evict(int page) {
+        if (lists.size(A1IN) > kin || lists.size(AM) == 0) {
+            int victim = lists.pop_back(A1IN);
+            lists.push_front(A1OUT, victim); // 只留下页面号
+            return victim;
+        }
+        return lists.pop_back(AM);
+    }
+
+    void load(int page) {
+        if (lists.list_of(page) == A1OUT) {
+            lists.push_front(AM, page);
+        }
+        else {
+            lists.push_front(A1IN, page);
+        }
+        trim();
+    }
+
+    // page 不经过 evict 离开页框：在 A1in 中的和被淘汰一样进 A1out，在 Am 中的直接去掉
+    void remove(int page) {
+        if (lists.list_of(page) == A1IN) {
+            lists.push_front(A1OUT, page);
+        }
+        else {
+            lists.remove(page);
+        }
+        trim();
+    }
+
+private:
+    void trim() {
+        while (lists.size(A1OUT) > kout) {
+            lists.pop_back(A1OUT);
+        }
+    }
+};
+
+// LIRS：按重用距离把页面分成 LIR（常驻）和 HIR，栈 S 按最近访问排序并保存非常驻 HIR 页面的历史，
+// 队列 Q 存常驻的 HIR 页面，淘汰总是从 Q 中选
+class Lirs {
+private:
+    KeyLists stack; // S，只用 0 号链表，表尾是栈底
+    KeyLists queue; // Q，只用 0 号链表，表尾最先淘汰
+    vector<char> lir; // 页面是否是 LIR
+    int lir_limit; // LIR 页面数上限，留 1% 且至少 1 个页框给 HIR
+    int lir_count = 0;
+public:
+    Lirs(int capacity = 0, int keys = 0) {
+        reset(capacity, keys);
+    }
+
+    void reset(int capacity, int keys) {
+        stack.reset(keys, 1);
+        queue.reset(keys, 1);
+        lir.assign(keys, 0);
+        lir_count = 0;
+        resize(capacity);
+    }
+
+    // LIR 上限随页框数变化，缩小时超出上限的 LIR 从栈底开始降级为常驻 HIR
+    void resize(int capacity) {
+        lir_limit = capacity - max(1, capacity / 100);
+        while (lir_count > lir_limit) {
+            demote_bottom();
+        }
+    }
+
+    // 命中常驻页面
+    void access(int page) {
+        if (lir[page]) {
+            bool bottom = stack.back(0) == page;
+            stack.push_front(0, page);
+            if (bottom) {
+                prune();
+            }
+        }
+        else if (stack.list_of(page) != -1) { // 常驻 HIR 且在栈中，重用距离比栈底 LIR 小
+            promote(page);
+        }
+        else {
+            stack.push_front(0, page);
+            queue.push_front(0, page); // 仍是 HIR，移到 Q 的末尾
+        }
+    }
+
+    int evict(int page) {
+        if (queue.back(0) == -1) { // 页框全是 LIR，先把栈底降级
+            demote_bottom();
+        }
+        int victim = queue.pop_back(0); // 在栈中的话留作非常驻 HIR
+        return victim;
+    }
+
+    void load(int page) {
+        if (lir_count < lir_limit) { // 刚开始 LIR 没满时直接作为 LIR
+            lir[page] = 1;
+            lir_count++;
+            stack.push_front(0, page);
+        }
+        else if (stack.list_of(page) != -1) { // 非常驻 HIR 仍在栈中，说明重用距离小
+            promote(page);
+        }
+        else {
+            stack.push_front(0, page);
+            queue.push_front(0, page);
+        }
+    }
+
+    // page 不经过 evict 离开页框：LIR 页面变成非常驻 HIR，留在栈中保存历史；常驻 HIR 移出 Q
+    void remove(int page) {
+        if (lir[page]) {
+            lir[page] = 0;
+            lir_count--;
+        }
+        else {
+            queue.remove(page);
+        }
+        prune();
+    }
+
+private:
+    // HIR 变成 LIR 放到栈顶，栈底的 LIR 降级
+    void promote(int page) {
+        lir[page] = 1;
+        lir_count++;
+        queue.remove(page);
+        stack.push_front(0, page);
+        demote_bottom();
+    }
+
+    // 栈底的 LIR 变成常驻 HIR，移出栈放到 Q 的末尾
+    void demote_bottom() {
+        prune(); // 只有 1 个页框时没有 LIR 上限，栈底可能还是 HIR
+        int bottom = stack.pop_back(0);
+        lir[bottom] = 0;
+        lir_count--;
+        queue.push_front(0, bottom);
+        prune();
+    }
+
+    // 栈底必须是 LIR，把栈底的 HIR 页面都移出栈
+    void prune() {
+        while (stack.back(0) != -1 && !lir[stack.back(0)]) {
+            stack.pop_back(0);
+        }
+    }
+};
+
+// OPT（Belady）：淘汰下一次访问最晚的页面，需要事先知道整个访问序列
+// prepare 从后往前扫一遍得到每次访问之后同一页面的下一次访问位置，
+// 常驻页面放在按下一次访问位置排序的大根堆里，每次访问和淘汰都是 O(log k)
+class Opt {
+private:
+    static constexpr int NEVER = INT_MAX; // 之后不再访问
+    vector<int> pages; // 访问序列中的页面号
+    vector<int> next_use; // next_use[i]：第 i 次访问之后同一页面的下一次访问位置
+    vector<int> first_use; // 每个页面第一次被访问的位置，给开始前预先装入的页面用
+    int now = 0; // 当前是第几次访问
+    vector<int> heap; // 常驻页面，按 key 的大根堆
+    vector<int> key; // 页面的下一次访问位置
+    vector<int> pos; // 页面在堆中的下标，-1 表示不在堆中
+public:
+    Opt(int capacity = 0, int keys = 0) {
+        reset(capacity, keys);
+    }
+
+    void reset(int capacity, int keys) {
+        pages.clear();
+        next_use.clear();
+        first_use.assign(keys, NEVER);
+        now = 0;
+        heap.clear();
+        heap.reserve(capacity);
+        key.assign(keys, NEVER);
+        pos.assign(keys, -1);
+    }
+
+    // 传入整个访问序列，从后往前一遍算出下一次访问位置
+    void prepare(const vector<int>& sequence) {
+        pages = sequence;
+        next_use.assign(pages.size(), NEVER);
+        for (int i = pages.size() - 1; i >= 0; i--) {
+            next_use[i] = first_use[pages[i]];
+            first_use[pages[i]] = i;
+        }
+        now = 0;
+    }
+
+    // 命中，进入下一次访问
+    void access(int page) {
+        update(page, next_use[now]);
+        now++;
+    }
+
+    // 淘汰下一次访问最晚的页面
+    int evict(int page) {
+        int victim = heap[0];
+        remove(victim);
+        return victim;
+    }
+
+    // 把常驻页面从堆中删掉
+    void remove(int page) {
+        int i = pos[page];
+        if (i == -1) {
+            return;
+        }
+        pos[page] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (i < heap.size()) {
+            heap[i] = last;
+            pos[last] = i;
+            sift_up(i);
+            sift_down(pos[last]);
+        }
+    }
+
+    // 开始访问之前预先装入的页面按第一次访问的位置排序，不占用任何一次访问
+    void preload(int page) {
+        update(page, first_use[page]);
+    }
+
+    // 缺页装入时进入下一次访问
+    void load(int page) {
+        if (now < pages.size() && pages[now] == page) {
+            update(page, next_use[now]);
+            now++;
+        }
+        else {
+            update(page, first_use[page]);
+        }
+    }
+
+    // 在 capacity 个页框上用 OPT 跑一遍访问序列，返回缺页次数，preloaded 是开始前已经装入的页面
+    // 用这个对象的缓冲区，反复调用时不再分配内存；常驻的页面就是堆中的页面
+    int count_faults(const vector<int>& sequence, int capacity, const vector<int>& preloaded, int keys) {
+        reset(capacity, keys);
+        prepare(sequence);
+        for (int i = 0; i < preloaded.size() && heap.size() < capacity; i++) {
+            preload(preloaded[i]);
+        }
+        int faults = 0;
+        for (int i = 0; i < sequence.size(); i++) {
+            int page = sequence[i];
+            if (pos[page] != -1) {
+                access(page);
+                continue;
+            }
+            faults++;
+            if (heap.size() == capacity) {
+                evict(page);
+            }
+            load(page);
+        }
+        return faults;
+    }
+
+private:
+    void update(int page, int value) {
+        key[page] = value;
+        if (pos[page] == -1) {
+            pos[page] = heap.size();
+            heap.push_back(page);
+        }
+        sift_up(pos[page]);
+        sift_down(pos[page]);
+    }
+
+    void swap_nodes(int a, int b) {
+        swap(heap[a], heap[b]);
+        pos[heap[a]] = a;
+        pos[heap[b]] = b;
+    }
+
+    void sift_up(int i) {
+        while (i > 0 && key[heap[(i - 1) / 2]] < key[heap[i]]) {
+            swap_nodes(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void sift_down(int i) {
+        for (;;) {
+            int largest = i;
+            int l = 2 * i + 1, r = 2 * i + 2;
+            if (l < heap.size() && key[heap[l]] > key[heap[largest]]) {
+                largest = l;
+            }
+            if (r < heap.size() && key[heap[r]] > key[heap[largest]]) {
+                largest = r;
+            }
+            if (largest == i) {
+                return;
+            }
+            swap_nodes(i, largest);
+            i = largest;
+        }
+    }
+};
+
+// 不需要事先知道访问序列的算法继承它，对这些算法来说预先装入和缺页装入没有区别
+template <class Derived>
+struct PolicyBase {
+    void prepare(const vector<int>& pages) {}
+
+    void on_preload(int page, int slot) {
+        static_cast<Derived*>(this)->on_load(page, slot);
+    }
+};
+
+// FIFO：槽位按装入顺序放在环形缓冲区里，淘汰最早装入的
+class FifoPolicy : public PolicyBase<FifoPolicy> {
+private:
+    vector<int> ring;
+    int head = 0, count = 0;
+public:
+    static const char* name() { return "FIFO"; }
+
+    FifoPolicy(int capacity, int keys) {
+        reset(capacity, keys);
+    }
+
+    void reset(int capacity, int keys) {
+        ring.assign(max(capacity, 1), 0);
+        head = count = 0;
+    }
+
+    void on_load(int page, int slot) {
+        if (count == ring.size()) { // 常驻集合比预计的大，扩大缓冲区
+            grow(ring.size() * 2);
+        }
+        ring[(head + count) % ring.size()] = slot;
+        count++;
+    }
+
+    void on_access(int page, int slot) {}
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        int slot = ring[head];
+        head = (head + 1) % ring.size();
+        count--;
+        return slot;
+    }
+
+    // 从装入顺序中去掉这个槽位，后面的依次前移
+    void on_remove(int page, int slot) {
+        int n = ring.size();
+        for (int i = 0; i < count; i++) {
+            if (ring[(head + i) % n] == slot) {
+                for (int j = i; j + 1 < count; j++) {
+                    ring[(head + j) % n] = ring[(head + j + 1) % n];
+                }
+                count--;
+                return;
+            }
+        }
+    }
+
+    void on_move(int page, int from, int to) {
+        for (int i = 0; i < count; i++) {
+            int& entry = ring[(head + i) % ring.size()];
+            if (entry == from) {
+                entry = to;
+                return;
+            }
+        }
+    }
+
+    void resize(int capacity) {
+        if (capacity > ring.size()) {
+            grow(capacity);
+        }
+    }
+
+private:
+    // 换一个 size 大小的缓冲区，保持装入顺序
+    void grow(int size) {
+        vector<int> bigger(size);
+        for (int i = 0; i < count; i++) {
+            bigger[i] = ring[(head + i) % ring.size()];
+        }
+        ring.swap(bigger);
+        head = 0;
+    }
+};
+
+class LruPolicy : public PolicyBase<LruPolicy> {
+private:
+    LruList lru;
+public:
+    static const char* name() { return "LRU"; }
+
+    LruPolicy(int capacity, int keys) : lru(capacity) {}
+
+    void reset(int capacity, int keys) {
+        lru.reset(capacity);
+    }
+
+    void on_load(int page, int slot) {
+        lru.touch(slot);
+    }
+
+    void on_access(int page, int slot) {
+        lru.touch(slot); // 移到表头，O(1)
+    }
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        return lru.evict(); // 链表尾就是最久未使用的槽位
+    }
+
+    void on_remove(int page, int slot) {
+        lru.remove(slot);
+    }
+
+    void on_move(int page, int from, int to) {
+        lru.move(from, to);
+    }
+
+    void resize(int capacity) {
+        lru.resize(capacity);
+    }
+};
+
+class ClockPolicy : public PolicyBase<ClockPolicy> {
+private:
+    Clock clock;
+public:
+    static const char* name() { return "CLOCK"; }
+
+    ClockPolicy(int capacity, int keys) : clock(capacity) {}
+
+    void reset(int capacity, int keys) {
+        clock.reset(capacity);
+    }
+
+    void on_load(int page, int slot) {
+        clock.reference(slot);
+    }
+
+    void on_access(int page, int slot) {
+        clock.reference(slot); // 只置访问位，不动任何链表
+    }
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        return clock.evict(); // 第一个没有第二次机会的槽位
+    }
+
+    void on_remove(int page, int slot) {
+        clock.clear(slot);
+    }
+
+    void on_move(int page, int from, int to) {
+        clock.move(from, to);
+    }
+
+    void resize(int capacity) {
+        clock.resize(capacity);
+    }
+};
+
+class EnhancedClockPolicy : public PolicyBase<EnhancedClockPolicy> {
+private:
+    Clock clock;
+public:
+    static const char* name() { return "ECLOCK"; }
+
+    EnhancedClockPolicy(int capacity, int keys) : clock(capacity) {}
+
+    void reset(int capacity, int keys) {
+        clock.reset(capacity);
+    }
+
+    void on_load(int page, int slot) {
+        clock.reference(slot);
+    }
+
+    void on_access(int page, int slot) {
+        clock.reference(slot);
+    }
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        return clock.evict_enhanced(resident.dirty); // 尽量淘汰没被修改过的页面，省去写回
+    }
+
+    void on_remove(int page, int slot) {
+        clock.clear(slot);
+    }
+
+    void on_move(int page, int from, int to) {
+        clock.move(from, to);
+    }
+
+    void resize(int capacity) {
+        clock.resize(capacity);
+    }
+};
+
+// ARC、2Q、LIRS、OPT 按页面号记录，淘汰时换算成页面所在的槽位，页面挪槽位时不用管
+class ArcPolicy : public PolicyBase<ArcPolicy> {
+private:
+    Arc arc;
+public:
+    static const char* name() { return "ARC"; }
+
+    ArcPolicy(int capacity, int keys) : arc(capacity, keys) {}
+
+    void reset(int capacity, int keys) {
+        arc.reset(capacity, keys);
+    }
+
+    void on_load(int page, int slot) {
+        arc.load(page);
+    }
+
+    void on_access(int page, int slot) {
+        arc.access(page);
+    }
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        return resident.page_slot[arc.evict(page)];
+    }
+
+    void on_remove(int page, int slot) {
+        arc.remove(page);
+    }
+
+    void on_move(int page, int from, int to) {}
+
+    void resize(int capacity) {
+        arc.resize(capacity);
+    }
+};
+
+class TwoQPolicy : public PolicyBase<TwoQPolicy> {
+private:
+    TwoQ two_q;
+public:
+    static const char* name() { return "2Q"; }
+
+    TwoQPolicy(int capacity, int keys) : two_q(capacity, keys) {}
+
+    void reset(int capacity, int keys) {
+        two_q.reset(capacity, keys);
+    }
+
+    void on_load(int page, int slot) {
+        two_q.load(page);
+    }
+
+    void on_access(int page, int slot) {
+        two_q.access(page);
+    }
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        return resident.page_slot[two_q.evict(page)];
+    }
+
+    void on_remove(int page, int slot) {
+        two_q.remove(page);
+    }
+
+    void on_move(int page, int from, int to) {}
+
+    void resize(int capacity) {
+        two_q.resize(capacity);
+    }
+};
+
+class LirsPolicy : public PolicyBase<LirsPolicy> {
+private:
+    Lirs lirs;
+public:
+    static const char* name() { return "LIRS"; }
+
+    LirsPolicy(int capacity, int keys) : lirs(capacity, keys) {}
+
+    void reset(int capacity, int keys) {
+        lirs.reset(capacity, keys);
+    }
+
+    void on_load(int page, int slot) {
+        lirs.load(page);
+    }
+
+    void on_access(int page, int slot) {
+        lirs.access(page);
+    }
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        return resident.page_slot[lirs.evict(page)];
+    }
+
+    void on_remove(int page, int slot) {
+        lirs.remove(page);
+    }
+
+    void on_move(int page, int from, int to) {}
+
+    void resize(int capacity) {
+        lirs.resize(capacity);
+    }
+};
+
+class OptPolicy {
+private:
+    Opt opt;
+public:
+    static const char* name() { return "OPT"; }
+
+    OptPolicy(int capacity, int keys) : opt(capacity, keys) {}
+
+    void reset(int capacity, int keys) {
+        opt.reset(capacity, keys);
+    }
+
+    void prepare(const vector<int>& pages) {
+        opt.prepare(pages); // OPT 要先知道整个访问序列
+    }
+
+    void on_preload(int page, int slot) {
+        opt.preload(page); // 不能算作第一次访问，否则之后的下一次访问位置全部错开
+    }
+
+    void on_load(int page, int slot) {
+        opt.load(page);
+    }
+
+    void on_access(int page, int slot) {
+        opt.access(page);
+    }
+
+    int choose_victim(int page, const ResidentSet& resident) {
+        return resident.page_slot[opt.evict(page)];
+    }
+
+    void on_remove(int page, int slot) {
+        opt.remove(page);
+    }
+
+    void on_move(int page, int from, int to) {}
+
+    void resize(int capacity) {} // 堆的大小跟着常驻页面走
+};
+
+// 检查一个类是否满足 ReplacementPolicy 约定，Process 用它在编译期报错
+template <class P, class = void>
+struct is_replacement_policy : false_type {};
+
+template <class P>
+struct is_replacement_policy<P, void_t<
+    decltype(P::name()),
+    decltype(P(0, 0)),
+    decltype(declval<P&>().reset(0, 0)),
+    decltype(declval<P&>().prepare(declval<const vector<int>&>())),
+    decltype(declval<P&>().on_preload(0, 0)),
+    decltype(declval<P&>().on_load(0, 0)),
+    decltype(declval<P&>().on_access(0, 0)),
+    decltype(declval<P&>().on_remove(0, 0)),
+    decltype(declval<P&>().on_move(0, 0, 0)),
+    decltype(declval<P&>().resize(0))>>
+    : is_convertible<decltype(declval<P&>().choose_victim(0, declval<const ResidentSet&>())), int> {};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "MyFt.h"
+
+// 每个进程自己的伪随机数发生器，不共享状态，不加锁
+// 整个运行只有一个种子（命令行 --seed），作业 i 用种子和 i 推出自己的状态：
+// 同一个种子下每个作业的随机序列固定，和作业由哪个工作线程、按什么顺序运行无关
+
+// splitmix64：把任意 64 位数打散，用来从种子推出发生器的状态
+inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256**，满足 UniformRandomBitGenerator，可以直接交给 <random> 里的分布
+class Random {
+private:
+    uint64_t s[4];
+public:
+    typedef uint64_t result_type;
+
+    // stream 区分同一个种子下的不同使用者，比如作业号
+    Random(uint64_t seed = 0, uint64_t stream = 0) {
+        uint64_t x = seed;
+        uint64_t mixed = splitmix64(x) ^ stream; // 先打散种子再加入 stream，相邻的种子和作业号不会撞到一起
+        for (int i = 0; i < 4; i++) {
+            s[i] = splitmix64(mixed);
+        }
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return UINT64_MAX;
+    }
+
+    result_type operator()() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // [0, n) 上均匀的整数
+    uint32_t below(uint32_t n) {
+        return (uint32_t)((((*this)() >> 32) * n) >> 32);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+// 没有给出种子时用的随机种子，输出出来，加上 --seed 就能重现这次运行
+inline uint64_t random_seed() {
+    random_device rd;
+    return ((uint64_t)rd() << 32) | rd();
+}
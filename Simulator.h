@@ -0,0 +1,1643 @@
+#pragma once
+
+#include "MyFt.h"
+#include "Policy.h"
+#include "Trace.h"
+#include "Log.h"
+#include "Stats.h"
+#include "Mrc.h"
+#include "Workload.h"
+#include "Random.h"
+
+
+
+// struct Process {
+//     int id;
+//     std::vector<int> pages;
+// };
+
+// 位图的同步方式：LOCKED 所有操作在一把互斥锁下进行；LOCK_FREE 用 CAS 直接修改原子字
+enum class BitMapMode { LOCKED, LOCK_FREE };
+
+// 位图类，每 64 个页框打包成一个字，1 表示已分配
+class BitMap {
+private:
+    unique_ptr<atomic<uint64_t>[]> words; // LOCKED 模式下只在锁内用 relaxed 读写
+    int word_count;
+    int size; // 页框总数
+    atomic<int> free_count; 
+    int hint; // LOCKED 模式下次从这个字开始找空闲页框（循环首次适应）
+    BitMapMode mode;
+    mutex mtx; 
+public:
+
+    BitMap(int size, BitMapMode mode = BitMapMode::LOCKED) : size(size), free_count(size), hint(0), mode(mode) {
+        word_count = (size + 63) / 64;
+        words.reset(new atomic<uint64_t>[word_count]);
+        for (int i = 0; i < word_count; i++) {
+            words[i].store(0, memory_order_relaxed);
+        }
+        if (size % 64 != 0) { // 最后一个字中超出 size 的位标成已分配，查找时不会选中
+            words[word_count - 1].store(~0ULL << (size % 64), memory_order_relaxed);
+        }
+    }
+
+    BitMapMode get_mode() const {
+        return mode;
+    }
+
+    int get_free_count() {
+        if (mode == BitMapMode::LOCK_FREE) {
+            return free_count.load(memory_order_acquire);
+        }
+        lock_guard<mutex> lock(mtx);
+        return free_count.load(memory_order_relaxed);
+    }
+
+   
+    int allocate_page() {
+        if (mode == BitMapMode::LOCK_FREE) {
+            if (!reserve(1)) {
+                return -1;
+            }
+            return claim_one();
+        }
+        lock_guard<mutex> lock(mtx); 
+        if (free_count.load(memory_order_relaxed) == 0) { 
+            return -1;
+        }
+        return take_one();
+    }
+
+    // 分配 n 个页框，追加到 out；空闲页框不足 n 个时不分配，返回 false
+    bool allocate_pages(int n, vector<int>& out) {
+        if (mode == BitMapMode::LOCK_FREE) {
+            if (!reserve(n)) {
+                return false;
+            }
+            for (int i = 0; i < n; i++) {
+                out.push_back(claim_one());
+            }
+            return true;
+        }
+        lock_guard<mutex> lock(mtx); // 一次加锁拿到全部页框
+        if (free_count.load(memory_order_relaxed) < n) {
+            return false;
+        }
+        for (int i = 0; i < n; i++) {
+            out.push_back(take_one());
+        }
+        return true;
+    }
+
+
+    void free_page(int page) {
+        if (page < 0 || page >= size) { 
+            return;
+        }
+        uint64_t bit = 1ULL << (page % 64);
+        if (mode == BitMapMode::LOCK_FREE) {
+            // 先清位再加计数，看到计数的分配者一定能找到这个空闲位
+            if (words[page / 64].fetch_and(~bit, memory_order_acq_rel) & bit) {
+                free_count.fetch_add(1, memory_order_release);
+            }
+            return;
+        }
+        lock_guard<mutex> lock(mtx); // 上锁
+        uint64_t w = words[page / 64].load(memory_order_relaxed);
+        if (w & bit) {
+            words[page / 64].store(w & ~bit, memory_order_relaxed); //清零，表示空闲
+            free_count.store(free_count.load(memory_order_relaxed) + 1, memory_order_relaxed); 
+        }
+    }
+
+private:
+    // LOCKED：调用前已加锁且 free_count > 0，一定能找到空闲页框
+    int take_one() {
+        for (int k = 0; k < word_count; k++) {
+            int w = hint + k < word_count ? hint + k : hint + k - word_count;
+            uint64_t bits = words[w].load(memory_order_relaxed);
+            if (~bits) { // 这个字里还有空闲位
+                int bit = __builtin_ctzll(~bits); // 最低的空闲位
+                words[w].store(bits | (1ULL << bit), memory_order_relaxed);
+                free_count.store(free_count.load(memory_order_relaxed) - 1, memory_order_relaxed);
+                hint = w;
+                return w * 64 + bit;
+            }
+        }
+        return -1;
+    }
+
+    // LOCK_FREE：先从 free_count 里预留 n 个页框，预留成功后位图里一定有对应数量的空闲位
+    bool reserve(int n) {
+        int count = free_count.load(memory_order_acquire);
+        while (count >= n) {
+            if (free_count.compare_exchange_weak(count, count - n, memory_order_acq_rel)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // LOCK_FREE：已经预留过一个页框，用 CAS 抢占一个空闲位
+    // 每个线程从自己上次成功的位置开始找，避免所有线程都挤在 0 号字上
+    int claim_one() {
+        static thread_local unsigned thread_hint = hash<thread::id>()(this_thread::get_id());
+        for (;;) {
+            for (int k = 0; k < word_count; k++) {
+                int w = (thread_hint + k) % word_count;
+                uint64_t bits = words[w].load(memory_order_relaxed);
+                while (~bits) {
+                    uint64_t bit = 1ULL << __builtin_ctzll(~bits);
+                    if (words[w].compare_exchange_weak(bits, bits | bit, memory_order_acq_rel)) {
+                        thread_hint = w;
+                        return w * 64 + __builtin_ctzll(bit);
+                    }
+                }
+            }
+        }
+    }
+};
+
+// 页面类
+class Page {
+private:
+    int job_id; 
+    int page_id; 
+public:
+    Page(int job_id = 0, int page_id = 0) : job_id(job_id), page_id(page_id) {}
+
+
+    int get_job_id() const {
+        return job_id;
+    }
+
+    int get_page_id() const {
+        return page_id;
+    }
+
+
+    friend std::ostream& operator<<(std::ostream& os, const Page& page) {
+        os << "<" << page.job_id << ", " << page.page_id << ">";
+        return os;
+    }
+
+
+    friend std::istream& operator>>(std::istream& is, Page& page) {
+        char c;
+        is >> c >> page.job_id >> c >> page.page_id >> c; // 格式与输出相同: <作业号, 页面号>
+        return is;
+    }
+};
+
+
+class Memory {
+private:
+    // 每个页框的内容 <作业号, 页面号> 正好放进一个 64 位原子字，读写页框不加锁；
+    // 每个页框独占一个缓存行，不同作业的页框相邻时也不会互相争用
+    struct alignas(64) Frame {
+        atomic<uint64_t> content;
+    };
+    unique_ptr<Frame[]> pages;
+    int page_count;
+    BitMap bitmap; // 位图记录内存页面的分配状态
+    mutex admit_mtx; // 准入队列的锁
+    condition_variable admit_cv; // 有页框被释放或队首作业离开时唤醒等待的作业
+    long long next_ticket = 0; // 下一个到达的作业拿到的排队号
+    long long serving = 0; // 当前排在队首的排队号
+    vector<pair<long long, int>> free_times; // 虚拟时间：空闲页框按被释放的时刻计数，按时刻排序，页框可以互换，不必记是哪一个；项数不超过页框数，预先留好空间
+    long long last_admit = 0; // 虚拟时间：上一个作业被准入的时刻，保证按到达顺序准入
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> arrivals; // 虚拟时间：排队的作业按 <到达时刻, 作业号> 准入
+    vector<char> arrived; // 虚拟时间：作业是否已经来排过队
+    int first_unarrived = 0; // 虚拟时间：还没来排过队的最小作业号
+    vector<const atomic<long long>*> running; // 虚拟时间：已准入的作业的时钟，它们之后释放页框的时刻不会早于时钟
+    long long last_release = 0; // 虚拟时间：最晚的释放时刻，也就是所有作业结束的时间
+public:
+    Memory(int size, BitMapMode mode = BitMapMode::LOCKED) : pages(new Frame[size / PAGE_SIZE]), page_count(size / PAGE_SIZE), bitmap(size / PAGE_SIZE, mode) {
+        for (int i = 0; i < page_count; i++) {
+            pages[i].content.store(pack(Page()), memory_order_relaxed);
+        }
+        free_times.reserve(page_count);
+        free_times.push_back(make_pair(0LL, page_count));
+    }
+
+    // 获取空闲页面的数量
+    int get_free_count() {
+        return bitmap.get_free_count(); 
+    }
+
+    int get_page_count() const {
+        return page_count;
+    }
+
+    //没有空闲页面，返回 -1
+    int allocate_page() {
+        return bitmap.allocate_page(); 
+    }
+
+    // 准入队列：按到达顺序排队，轮到自己并且空闲页框不少于 n 个时一次性分配 n 个页框
+    // 需要等待时先调用一次 on_wait；返回虚拟时间下作业被准入的时刻
+    long long reserve_pages(int n, vector<int>& frames, const function<void()>& on_wait = nullptr) {
+        unique_lock<mutex> lock(admit_mtx);
+        long long ticket = next_ticket++;
+        if ((ticket != serving || bitmap.get_free_count() < n) && on_wait) {
+            on_wait();
+        }
+        // allocate_pages 要么一次拿到 n 个页框，要么什么都不拿，不会超额分配
+        admit_cv.wait(lock, [&] { return ticket == serving && bitmap.allocate_pages(n, frames); });
+        serving++;
+        admit_cv.notify_all(); // 下一个排队的作业也许已经可以满足
+        return take_free_times(n);
+    }
+
+    // 虚拟时间下的准入：结果只由虚拟时间决定，和哪个线程先抢到锁无关
+    // 第一次来的作业到达时刻都是 0，按作业号准入；挂起后回来的作业按回来时的虚拟时刻排队
+    // 轮到自己后，还要等正在运行的作业的时钟都不早于自己要用的页框的空闲时刻（或它们已经结束），
+    // 这时它们以后释放的页框都不会更早，取到的最早空闲的 n 个页框才是确定的
+    // clock 是这个作业的虚拟时钟，准入后一直登记在 running 里，直到 free_pages 传回它
+    long long reserve_pages_at(int job_id, long long arrival, const atomic<long long>* clock, int n, vector<int>& frames, const function<void()>& on_wait = nullptr) {
+        unique_lock<mutex> lock(admit_mtx);
+        if (job_id >= arrived.size()) {
+            arrived.resize(job_id + 1, 0);
+        }
+        bool first = !arrived[job_id];
+        arrived[job_id] = 1;
+        while (first_unarrived < arrived.size() && arrived[first_unarrived]) {
+            first_unarrived++;
+        }
+        pair<long long, int> key(arrival, job_id);
+        arrivals.push(key);
+        auto ready = [&] {
+            if (arrivals.top() != key || (first && first_unarrived <= job_id)) { // 前面还有作业，或者作业号更小的作业还没来
+                return false;
+            }
+            long long horizon = running_horizon();
+            return arrival <= horizon && nth_free_time(n) <= horizon && bitmap.allocate_pages(n, frames);
+        };
+        if (!ready()) {
+            if (on_wait) {
+                on_wait();
+            }
+            while (!ready()) { // 正在运行的作业推进时钟时不通知，定时重新检查
+                admit_cv.wait_for(lock, chrono::milliseconds(1));
+            }
+        }
+        arrivals.pop();
+        running.push_back(clock);
+        admit_cv.notify_all();
+        return take_free_times(n);
+    }
+
+    void free_page(int page, long long time = 0) {
+        free_pages(&page, 1, time);
+    }
+
+    void free_pages(const vector<int>& frames, long long time = 0, const atomic<long long>* leaving = nullptr) {
+        free_pages(frames.data(), frames.size(), time, leaving);
+    }
+
+    // 一次释放多个页框，只唤醒一次等待的作业；time 是释放时的虚拟时间
+    // leaving 是 reserve_pages_at 登记过的作业时钟，作业不再运行（结束或挂起）时传回，和页框在同一把锁下一起注销
+    void free_pages(const int* frames, int n, long long time = 0, const atomic<long long>* leaving = nullptr) {
+        {
+            lock_guard<mutex> lock(admit_mtx); // 等待者检查条件和睡眠都在这把锁下，拿着锁修改避免丢失唤醒
+            for (int i = 0; i < n; i++) { // 位图和 free_times 一起改，不会有页框已经能分配却还没记下空闲时刻
+                bitmap.free_page(frames[i]);
+            }
+            if (leaving) {
+                running.erase(find(running.begin(), running.end(), leaving));
+            }
+            auto it = lower_bound(free_times.begin(), free_times.end(), make_pair(time, INT_MIN));
+            if (it != free_times.end() && it->first == time) {
+                it->second += n;
+            }
+            else {
+                free_times.insert(it, make_pair(time, n));
+            }
+            last_release = max(last_release, time);
+        }
+        admit_cv.notify_all();
+    }
+
+    // 不排队地取一个空闲页框，给正在运行的作业扩大常驻集合；有作业在排队时先让它们准入，返回 -1
+    // 虚拟时间下只取在 now 时刻之前已经空闲的页框
+    int try_allocate_page(long long now = LLONG_MAX) {
+        lock_guard<mutex> lock(admit_mtx);
+        if (next_ticket != serving || !arrivals.empty() || free_times.empty() || free_times.begin()->first > now) {
+            return -1;
+        }
+        int frame = bitmap.allocate_page();
+        if (frame == -1) {
+            return -1;
+        }
+        if (--free_times.front().second == 0) {
+            free_times.erase(free_times.begin());
+        }
+        return frame;
+    }
+
+    // 有没有作业在排队等待准入，挂起自己让出内存只在有人等时才有意义
+    bool has_waiters() {
+        lock_guard<mutex> lock(admit_mtx);
+        return next_ticket != serving || !arrivals.empty();
+    }
+
+    long long get_last_release() {
+        lock_guard<mutex> lock(admit_mtx);
+        return last_release;
+    }
+
+   
+    Page read_page(int page) {
+        if (page >= 0 && page < page_count) { 
+            return unpack(pages[page].content.load(memory_order_acquire)); 
+        }
+        return Page(-1, -1); 
+    }
+
+    //传入页面号和页面对象
+    void write_page(int page, Page p) {
+        if (page >= 0 && page < page_count) { 
+            pages[page].content.store(pack(p), memory_order_release); 
+        }
+    }
+
+private:
+    // 虚拟时间下取最早空闲的 n 个页框，第 n 个空闲的时刻就是能开始的时刻，但不能早于前一个作业
+    long long take_free_times(int n) {
+        long long time = 0;
+        int used = 0; // 用完的项数
+        for (int taken = 0; taken < n && used < free_times.size(); ) {
+            pair<long long, int>& earliest = free_times[used];
+            int k = min(n - taken, earliest.second);
+            time = earliest.first;
+            taken += k;
+            if ((earliest.second -= k) == 0) {
+                used++;
+            }
+        }
+        free_times.erase(free_times.begin(), free_times.begin() + used);
+        last_admit = max(last_admit, time);
+        return last_admit;
+    }
+
+    // 第 n 个空闲的页框的空闲时刻，不够 n 个时是 LLONG_MAX
+    long long nth_free_time(int n) const {
+        for (int i = 0; i < free_times.size(); i++) {
+            if ((n -= free_times[i].second) <= 0) {
+                return free_times[i].first;
+            }
+        }
+        return LLONG_MAX;
+    }
+
+    // 正在运行的作业中最慢的时钟，没有正在运行的作业时是 LLONG_MAX
+    long long running_horizon() const {
+        long long horizon = LLONG_MAX;
+        for (int i = 0; i < running.size(); i++) {
+            horizon = min(horizon, running[i]->load(memory_order_relaxed));
+        }
+        return horizon;
+    }
+
+    static uint64_t pack(const Page& p) {
+        return (uint64_t)(uint32_t)p.get_job_id() << 32 | (uint32_t)p.get_page_id();
+    }
+
+    static Page unpack(uint64_t v) {
+        return Page((int32_t)(v >> 32), (int32_t)(uint32_t)v);
+    }
+};
+
+
+
+// 文件格式：TEXT 每行一个定长的 <作业号, 页面号>；BINARY 第 i 个页面放在第 i*PAGE_SIZE 字节处
+// 两种格式的记录都是定长的，第 i 个页面总在 i*记录长度 处，可以原地改写
+enum class FileFormat { TEXT, BINARY };
+
+// 二进制文件中的一个页面记录，大小正好是一个页面
+struct PageRecord {
+    uint32_t magic; // PAGE_MAGIC，用来校验文件
+    int32_t job_id;
+    int32_t page_id;
+    char data[PAGE_SIZE - 3 * sizeof(int32_t)]; // 页面其余内容
+};
+static_assert(sizeof(PageRecord) == PAGE_SIZE, "PageRecord must fill exactly one page");
+
+class File {
+private:
+    int job_id = -1;
+    string file_name; 
+    FileFormat format = FileFormat::BINARY;
+    vector<Page> pages; // TEXT 格式的页面
+    int fd = -1; // 文件描述符，原地写页面用
+    const PageRecord* records = nullptr; // BINARY 格式的只读映射，换入页面时直接读这里
+    size_t mapped_size = 0;
+    bool write_back = false; // true 时 write_page 只把页面标脏，flush 时再成批写盘
+    vector<char> dirty; // 每个页面是否等待写回
+    vector<PageRecord> staged; // BINARY 格式等待写回的页面内容
+    vector<char> flush_buffer; // flush 时拼接相邻的脏页面
+    int dirty_count = 0;
+    bool loaded = false; // 已有的文件在第一次读写时才校验和映射
+public:
+    // 还没有打开任何文件，之后用 open 打开
+    File() {}
+
+    // reuse 为 true 时直接打开已有的文件，只有文件不存在才生成；为 false 时总是重新生成
+    File(int job_id, FileFormat format = FileFormat::BINARY, bool reuse = true) {
+        open(job_id, format, reuse);
+    }
+
+    ~File() {
+        close();
+    }
+
+    // 关掉当前的文件改为打开作业 job_id 的文件，缓冲区留着复用，进程对象被下一个作业复用时调用
+    void open(int job_id, FileFormat format = FileFormat::BINARY, bool reuse = true) {
+        close();
+        this->job_id = job_id;
+        this->format = format;
+        file_name = file_path(job_id, format); // 根据作业号生成文件名
+        dirty.assign(VIRTUAL_PAGE_NUM, 0);
+        dirty_count = 0;
+        write_back = false;
+        loaded = false;
+        if (reuse) {
+            fd = ::open(file_name.c_str(), O_RDWR);
+        }
+        if (fd == -1) {
+            create();
+        }
+    }
+
+    // 写回还没落盘的页面，解除映射、关闭文件
+    void close() {
+        flush();
+        if (records) {
+            munmap((void*)records, mapped_size);
+            records = nullptr;
+            mapped_size = 0;
+        }
+        if (fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    static string file_path(int job_id, FileFormat format) {
+        return FILE_PREFIX + to_string(job_id) + (format == FileFormat::BINARY ? BINARY_FILE_SUFFIX : FILE_SUFFIX);
+    }
+
+    // 每个页面记录在文件中占的字节数
+    static size_t record_size(FileFormat format) {
+        return format == FileFormat::BINARY ? sizeof(PageRecord) : TEXT_RECORD_SIZE;
+    }
+
+    // 把已有的文本文件 file_N.txt 转换成二进制文件 file_N.bin，失败返回 false
+    static bool import_text(int job_id) {
+        ifstream ifs(file_path(job_id, FileFormat::TEXT));
+        if (!ifs.is_open()) {
+            return false;
+        }
+        vector<PageRecord> out(VIRTUAL_PAGE_NUM);
+        for (int i = 0; i < VIRTUAL_PAGE_NUM; i++) {
+            Page p;
+            if (!(ifs >> p)) {
+                return false;
+            }
+            fill_record(out[i], p);
+        }
+        return write_records(file_path(job_id, FileFormat::BINARY), out.data(), out.size());
+    }
+
+    // 开启后 write_page 只标脏，直到 flush/sync 才写盘；关闭时先把脏页面写回
+    void set_write_back(bool enable) {
+        if (!enable) {
+            flush();
+        }
+        write_back = enable;
+    }
+
+    // 将文件写入磁盘
+    void write_to_disk() {
+        if (format == FileFormat::BINARY) {
+            vector<PageRecord> out(pages.size());
+            for (int i = 0; i < pages.size(); i++) {
+                fill_record(out[i], pages[i]);
+            }
+            write_records(file_name, out.data(), out.size());
+            return;
+        }
+        ofstream ofs(file_name);
+        if (ofs.is_open()) { 
+            char line[TEXT_RECORD_SIZE + 1];
+            for (int i = 0; i < pages.size(); i++) { 
+                format_text_record(line, pages[i]);
+                ofs.write(line, TEXT_RECORD_SIZE); 
+            }
+            ofs.close(); 
+        }
+    }
+
+   
+    void read_from_disk() {
+        if (format == FileFormat::BINARY) {
+            return; // 映射始终反映磁盘内容
+        }
+        ifstream ifs(file_name); 
+        if (ifs.is_open()) { 
+            for (int i = 0; i < pages.size(); i++) { 
+                ifs >> pages[i];
+            }
+            ifs.close(); 
+        }
+    }
+
+    // 读取一个页面的内容，传入页面号，返回页面对象
+    Page read_page(int page) {
+        load();
+        if (format == FileFormat::BINARY) {
+            if (page >= 0 && page < VIRTUAL_PAGE_NUM && dirty[page]) { // 还没写回的页面以暂存的为准
+                return Page(staged[page].job_id, staged[page].page_id);
+            }
+            if (records && page >= 0 && page < VIRTUAL_PAGE_NUM) {
+                const PageRecord& r = records[page]; // 换入只是读映射里的一条记录
+                return Page(r.job_id, r.page_id);
+            }
+            return Page(-1, -1);
+        }
+        if (page >= 0 && page < pages.size()) { 
+            return pages[page]; 
+        }
+        return Page(-1, -1); 
+    }
+
+    // 写一个页面，只写这一条记录，不重写整个文件
+    void write_page(int page, Page p) {
+        if (page < 0 || page >= VIRTUAL_PAGE_NUM) { 
+            return;
+        }
+        load();
+        if (format == FileFormat::TEXT) {
+            pages[page] = p; 
+        }
+        if (write_back) {
+            if (format == FileFormat::BINARY) {
+                if (staged.empty()) {
+                    staged.resize(VIRTUAL_PAGE_NUM);
+                }
+                fill_record(staged[page], p);
+            }
+            if (!dirty[page]) {
+                dirty[page] = 1;
+                dirty_count++;
+            }
+            return;
+        }
+        vector<char> buf(record_size(format));
+        encode(buf.data(), p);
+        write_at(page, buf.data(), 1);
+    }
+
+    // 把所有脏页面写回，相邻的脏页面合并成一次 pwrite
+    void flush() {
+        if (dirty_count == 0) {
+            return;
+        }
+        size_t rs = record_size(format);
+        vector<char>& buf = flush_buffer;
+        for (int i = 0; i < VIRTUAL_PAGE_NUM; ) {
+            if (!dirty[i]) {
+                i++;
+                continue;
+            }
+            int j = i;
+            buf.clear();
+            while (j < VIRTUAL_PAGE_NUM && dirty[j]) {
+                buf.resize(buf.size() + rs);
+                encode(&buf[buf.size() - rs], format == FileFormat::BINARY ? Page(staged[j].job_id, staged[j].page_id) : pages[j]);
+                dirty[j] = 0;
+                j++;
+            }
+            write_at(i, buf.data(), j - i);
+            i = j;
+        }
+        dirty_count = 0;
+    }
+
+    // flush 之后再把数据刷到磁盘上
+    void sync() {
+        flush();
+        if (fd != -1) {
+            fdatasync(fd);
+        }
+    }
+
+private:
+    // 生成全部页面并写盘，然后打开文件
+    void create() {
+        if (records) {
+            munmap((void*)records, mapped_size);
+            records = nullptr;
+        }
+        pages.assign(VIRTUAL_PAGE_NUM, Page());
+        for (int i = 0; i < VIRTUAL_PAGE_NUM; i++) { 
+            pages[i] = Page(job_id, i); 
+        }
+        write_to_disk(); 
+        if (fd == -1) {
+            fd = ::open(file_name.c_str(), O_RDWR);
+            if (fd == -1) {
+                cerr << "Failed to open " << file_name << endl;
+            }
+        }
+        loaded = true;
+        if (format == FileFormat::BINARY) {
+            pages.clear(); // 之后以映射为准
+            pages.shrink_to_fit();
+            map_file();
+        }
+    }
+
+    // 第一次读写已有文件时校验内容，BINARY 格式建立映射，TEXT 格式读入页面；文件损坏就重新生成
+    void load() {
+        if (loaded) {
+            return;
+        }
+        loaded = true;
+        if (format == FileFormat::BINARY) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size == (off_t)VIRTUAL_PAGE_NUM * sizeof(PageRecord)) { // 长度不对时映射会越界
+                map_file();
+            }
+            if (records && valid_record(records[0], 0) && valid_record(records[VIRTUAL_PAGE_NUM - 1], VIRTUAL_PAGE_NUM - 1)) {
+                return;
+            }
+            cerr << file_name << " is invalid, regenerating it." << endl;
+            create();
+            return;
+        }
+        pages.assign(VIRTUAL_PAGE_NUM, Page(-1, -1)); // 没读到的页面校验不通过
+        read_from_disk();
+        for (int i = 0; i < VIRTUAL_PAGE_NUM; i++) {
+            if (pages[i].get_job_id() != job_id) {
+                cerr << file_name << " is invalid, regenerating it." << endl;
+                create();
+                return;
+            }
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size != (off_t)VIRTUAL_PAGE_NUM * TEXT_RECORD_SIZE) {
+            write_to_disk(); // 旧的不定长文本文件，改写成定长记录才能原地写
+        }
+    }
+
+    bool valid_record(const PageRecord& r, int page) const {
+        return r.magic == PAGE_MAGIC && r.job_id == job_id && r.page_id == page;
+    }
+
+    static void fill_record(PageRecord& r, const Page& p) {
+        memset(&r, 0, sizeof(r));
+        r.magic = PAGE_MAGIC;
+        r.job_id = p.get_job_id();
+        r.page_id = p.get_page_id();
+    }
+
+    // 定长的文本记录：<作业号, 页面号>，空格补齐，最后是换行
+    static void format_text_record(char* line, const Page& p) {
+        char text[TEXT_RECORD_SIZE];
+        snprintf(text, sizeof(text), "<%d, %d>", p.get_job_id(), p.get_page_id());
+        snprintf(line, TEXT_RECORD_SIZE + 1, "%-*s\n", TEXT_RECORD_SIZE - 1, text);
+    }
+
+    // 按本文件的格式把页面编码成一条记录
+    void encode(char* out, const Page& p) {
+        if (format == FileFormat::BINARY) {
+            fill_record(*(PageRecord*)out, p);
+        }
+        else {
+            char line[TEXT_RECORD_SIZE + 1];
+            format_text_record(line, p);
+            memcpy(out, line, TEXT_RECORD_SIZE);
+        }
+    }
+
+    // 从第 page 个记录开始写 count 条记录
+    void write_at(int page, const char* data, int count) {
+        if (fd != -1) {
+            size_t rs = record_size(format);
+            pwrite(fd, data, count * rs, (off_t)page * rs);
+        }
+    }
+
+    static bool write_records(const string& name, const PageRecord* data, size_t count) {
+        int out = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out == -1) {
+            return false;
+        }
+        bool ok = write(out, data, count * sizeof(PageRecord)) == (ssize_t)(count * sizeof(PageRecord));
+        ::close(out);
+        return ok;
+    }
+
+    void map_file() {
+        if (fd == -1) {
+            return;
+        }
+        mapped_size = (size_t)VIRTUAL_PAGE_NUM * sizeof(PageRecord);
+        void* addr = mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0); // 共享映射，pwrite 的修改可以直接看到
+        if (addr == MAP_FAILED) {
+            mapped_size = 0;
+            cerr << "Failed to map " << file_name << endl;
+            return;
+        }
+        records = (const PageRecord*)addr;
+    }
+};
+
+
+
+// 全局置换模式下所有作业共用的页框池
+// 作业只为页表单独分配一个页框，页面都装在池里；替换算法在整个池上选牺牲页面，一个作业缺页时可能换出其他作业的页面
+// 池的状态和全局模式下对各作业文件的读写都在一把锁下进行，替换算法的状态本来就是全局共享的
+class FramePool {
+protected:
+    mutex mtx;
+    Memory* memory;
+    vector<int> frames; // 池中的页框，下标是槽位
+    ResidentSet resident; // page_slot 以全局页面号 作业号 * VIRTUAL_PAGE_NUM + 页面号 为下标
+    vector<int> slot_key; // 槽位中页面的全局页面号
+    vector<pair<int, int>> owners; // 反向映射：物理页框号 -> <作业号, 页面号>，没装过页面是 <-1, -1>
+    int filled = 0; // 已经装过页面的槽位数，装满之前缺页不需要替换
+    vector<File*> files; // 正在运行的作业的文件，作业结束后为 nullptr，它留在池里的页面不再写回
+    vector<long long> stolen; // 每个作业被其他正在运行的作业换出的页面数
+public:
+    FramePool(Memory* memory, int size, int jobs) : memory(memory), files(jobs, nullptr), stolen(jobs, 0) {
+        memory->reserve_pages(size, frames);
+        resident.frames = frames;
+        resident.page_slot.assign(jobs * VIRTUAL_PAGE_NUM, -1);
+        resident.dirty.assign(size, 0);
+        slot_key.assign(size, -1);
+        owners.assign(memory->get_page_count(), make_pair(-1, -1));
+    }
+
+    virtual ~FramePool() {
+        memory->free_pages(frames);
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    int size() const {
+        return frames.size();
+    }
+
+    // 作业开始运行，之后它的页面换出时写回 file
+    void attach(int job_id, File* file) {
+        lock_guard<mutex> lock(mtx);
+        files[job_id] = file;
+    }
+
+    // 作业结束，返回它被其他作业换出的页面数
+    long long detach(int job_id) {
+        lock_guard<mutex> lock(mtx);
+        files[job_id] = nullptr;
+        return stolen[job_id];
+    }
+};
+
+// 在池中访问一个页面的结果
+struct PoolAccess {
+    int frame; // 页面所在的物理页框
+    bool fault = false;
+    bool evicted = false; // 换出了池中的一个页面
+    bool stole = false; // 换出的是另一个正在运行的作业的页面
+    bool wrote_back = false; // 换出的页面是脏的，写回了它的文件
+    Page old; // 被换出的页面
+};
+
+template <class Policy>
+class GlobalPool : public FramePool {
+private:
+    Policy policy;
+public:
+    GlobalPool(Memory* memory, int size, int jobs) : FramePool(memory, size, jobs), policy(size, jobs * VIRTUAL_PAGE_NUM) {}
+
+    // 作业 job_id 访问自己的 page 页面，不在池里就换入，必要时由替换算法在整个池上选出牺牲页面
+    PoolAccess access(int job_id, int page, bool write) {
+        lock_guard<mutex> lock(mtx);
+        PoolAccess result;
+        int key = job_id * VIRTUAL_PAGE_NUM + page;
+        int slot = resident.page_slot[key];
+        if (slot != -1) {
+            policy.on_access(key, slot);
+        }
+        else {
+            result.fault = true;
+            if (filled < frames.size()) {
+                slot = filled++; // 池还没装满，直接用空槽位
+            }
+            else {
+                slot = policy.choose_victim(key, resident);
+                pair<int, int> victim = owners[frames[slot]];
+                result.evicted = true;
+                result.old = memory->read_page(frames[slot]);
+                result.stole = victim.first != job_id && files[victim.first];
+                if (result.stole) {
+                    stolen[victim.first]++;
+                }
+                if (resident.dirty[slot] && files[victim.first]) {
+                    files[victim.first]->write_page(victim.second, result.old); // 脏页面写回它所属作业的文件
+                    result.wrote_back = true;
+                }
+                resident.page_slot[slot_key[slot]] = -1;
+            }
+            resident.dirty[slot] = 0;
+            resident.page_slot[key] = slot;
+            slot_key[slot] = key;
+            owners[frames[slot]] = make_pair(job_id, page);
+            memory->write_page(frames[slot], files[job_id]->read_page(page));
+            policy.on_load(key, slot);
+        }
+        if (write) {
+            resident.dirty[slot] = 1;
+        }
+        result.frame = frames[slot];
+        return result;
+    }
+};
+
+// 每个作业的页框数：FIXED 固定 PROCESS_PAGE_NUM 个；WORKING_SET 跟随工作集大小；PFF 按缺页频率增减
+enum class AllocMode { FIXED, WORKING_SET, PFF };
+
+// 一次模拟运行的配置，由 main 根据命令行填好
+struct SimConfig {
+    string algorithm; // 页面替换算法名
+    int workers = 1; // 并行运行作业的工作线程数
+    BitMapMode bitmap_mode = BitMapMode::LOCKED;
+    FileFormat file_format = FileFormat::BINARY;
+    string trace_prefix; // 不为空时作业从轨迹文件读访问序列，而不是随机生成
+    bool virtual_time = false; // 为 true 时休眠和磁盘读写只推进虚拟时钟，不真的等待
+    Logger* logger = nullptr; // 访问日志，为空时不记录
+    Stats* stats = nullptr; // 统计汇总，为空时不汇总
+    bool global_replacement = false; // 为 true 时所有作业共用一个页框池，在整个池上选牺牲页面
+    FramePool* pool = nullptr; // 全局置换模式下由 run_jobs 创建，类型是 GlobalPool<Policy>
+    AllocMode allocation = AllocMode::FIXED;
+    WorkloadSpec workload; // 随机生成访问序列时的分布，默认和说明中一样是 1/(i+1)^(1/2)
+    long long accesses = ACCESS_NUM; // 随机生成时每个作业的访问次数
+    uint64_t seed = 0; // 整个运行的随机种子，每个作业由它和作业号推出自己的随机数发生器
+};
+
+// 按 config 随机生成一个作业的访问：逻辑地址和是否是写操作；rng 是作业自己的随机数发生器
+inline void generate_accesses(const SimConfig& config, Random& rng, vector<int>& access_list, vector<char>& write_list) {
+    Workload workload(config.workload);
+    generate_workload(workload, config.accesses, access_list, write_list, rng);
+}
+
+// 模拟进程，Policy 是满足 ReplacementPolicy 约定的页面替换算法
+// 进程对象可以反复使用：start 开始一个作业，把所有状态原地重置，页表、访问列表、替换算法等的缓冲区都留着接着用
+template <class Policy>
+class Process {
+    static_assert(is_replacement_policy<Policy>::value, "Policy does not satisfy ReplacementPolicy");
+private:
+    int job_id = -1; // 作业号
+    int page_table_base = -1; // 页表的基地址
+    vector<int> page_table; // 页表
+    ResidentSet resident; // 常驻集合：槽位、页面所在槽位、修改位
+    vector<int> access_list; // 访问列表
+    vector<char> write_list; // 每次访问是否是写操作
+    unique_ptr<TraceReader> trace; // 轨迹模式下流式读取访问序列，不生成 access_list
+    bool virtual_time = false; // 是否使用虚拟时间
+    long long clock = 0; // 虚拟时钟，毫秒
+    atomic<long long> shared_clock{0}; // clock 的副本，准入时 Memory 据此判断运行中的作业还会不会更早释放页框
+    long long start_time = 0; // 得到内存开始运行的虚拟时间
+    Logger* logger = nullptr; // 访问日志
+    Random rng; // 作业自己的随机数发生器，生成访问序列和休眠时间
+    Workload workload; // 访问序列的生成器，配置的分布不变时跨作业保留
+    ProcessStats stats; // 访问、缺页、置换等计数
+    Stats* global_stats = nullptr; // 进程结束时把 stats 交给它汇总
+    GlobalPool<Policy>* pool = nullptr; // 全局置换模式下页面装在共用的页框池里，否则为空，只在自己的页框中置换
+    Memory* memory = nullptr; // 内存指针
+    File file; // 进程的文件，作业结束时关闭
+    Policy policy; // 页面替换算法
+    AllocMode allocation = AllocMode::FIXED; // 页框数是否随运行调整
+    vector<int> empty_slots; // 还没有装入页面的槽位，缺页时先用它们
+    vector<long long> last_ref; // 动态分配：每个页面最近一次被访问是第几次访问
+    vector<int> window; // 工作集：最近 WS_WINDOW 次访问的页面，环形缓冲区
+    vector<int> window_count; // 工作集：每个页面在窗口中出现的次数
+    int ws_size = 0; // 工作集大小，窗口中不同页面的个数
+    long long last_fault = 0; // PFF：上一次缺页是第几次访问
+    int failed_growth = 0; // 连续想扩大常驻集合却拿不到页框的次数
+    vector<int> page_list; // access_pages 的结果
+    vector<int> reserved; // admit 分到的页框
+    vector<int> released; // 要还给内存的页框
+    Opt bound; // 算 OPT 下界用
+    vector<int> preloaded; // 开始前预先装入的页面，算 OPT 下界用
+public:
+    Process() : policy(PROCESS_PAGE_NUM, VIRTUAL_PAGE_NUM) {}
+
+    Process(int job_id, Memory* memory, const SimConfig& config) : policy(PROCESS_PAGE_NUM, VIRTUAL_PAGE_NUM) {
+        start(job_id, memory, config);
+    }
+
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+
+    // 开始运行作业 job_id：重置上一个作业留下的状态，生成访问序列，分配内存
+    void start(int job_id, Memory* memory, const SimConfig& config) {
+        this->job_id = job_id; 
+        this->memory = memory;
+        this->virtual_time = config.virtual_time;
+        this->logger = config.logger;
+        this->rng = Random(config.seed, job_id);
+        this->pool = static_cast<GlobalPool<Policy>*>(config.pool); // run_jobs 按同一个 Policy 创建
+        this->allocation = config.allocation;
+        clock = 0;
+        shared_clock.store(0, memory_order_relaxed);
+        start_time = 0;
+        empty_slots.clear();
+        ws_size = 0;
+        last_fault = 0;
+        failed_growth = 0;
+        if (allocation != AllocMode::FIXED) {
+            last_ref.assign(VIRTUAL_PAGE_NUM, -1);
+            window.assign(WS_WINDOW, -1);
+            window_count.assign(VIRTUAL_PAGE_NUM, 0);
+        }
+        file.open(job_id, config.file_format); // 已有文件直接打开，不再每次重新生成
+        page_table.assign(VIRTUAL_PAGE_NUM, -1); 
+        resident.frames.clear();
+        resident.dirty.clear();
+        resident.page_slot.assign(VIRTUAL_PAGE_NUM, -1);
+        policy.reset(PROCESS_PAGE_NUM, VIRTUAL_PAGE_NUM);
+        file.set_write_back(true); // 换出的脏页面先暂存，进程结束时一起写回
+        this->global_stats = config.stats;
+        stats = ProcessStats();
+        stats.job_id = job_id;
+        stats.policy = Policy::name();
+        access_list.clear();
+        write_list.clear();
+        trace.reset();
+        if (!config.trace_prefix.empty()) {
+            string path = TraceReader::path_for(config.trace_prefix, job_id);
+            trace.reset(new TraceReader(path));
+            if (!trace->is_open()) {
+                print_line("Job %d cannot open trace %s, generating accesses instead.", job_id, path.c_str());
+                trace.reset();
+            }
+        }
+        if (!trace) {
+            generate_access_list(config); // 生成访问列表
+        }
+        policy.prepare(access_pages());
+        if (pool) {
+            pool->attach(job_id, &file);
+        }
+        allocate_memory(); // 分配内存
+    }
+
+    // 作业结束后关闭文件和轨迹，进程对象留着给下一个作业用
+    void finish() {
+        file.close();
+        trace.reset();
+    }
+
+ 
+    void generate_access_list(const SimConfig& config) {
+        if (workload.get_spec() != config.workload) {
+            workload = Workload(config.workload);
+        }
+        workload.restart();
+        generate_workload(workload, config.accesses, access_list, write_list, rng);
+    }
+
+
+    void allocate_memory() {
+        int pages = PROCESS_PAGE_NUM;
+        if (pool) {
+            pages = 0; // 全局置换模式下只为页表分配页框
+        }
+        else if (allocation != AllocMode::FIXED) {
+            pages = MIN_PROCESS_PAGE_NUM; // 动态分配时先少给一些，运行中再按需要增减
+        }
+        admit(pages, true);
+    }
+
+    // 排队等到 pages 个页面加一个页表的页框；preload 为 true 时预先装入前 pages 个页面，否则槽位先空着，缺页时再装入
+    void admit(int pages, bool preload) {
+        reserved.clear();
+        int needed = pages + 1;
+        long long arrival = now();
+        auto on_wait = [this] { // 空闲页面数不足时排队等待
+            log(LogEventType::WAIT); // 输出等待信息
+        };
+        long long admitted = virtual_time ? memory->reserve_pages_at(job_id, clock, &shared_clock, needed, reserved, on_wait)
+                                          : memory->reserve_pages(needed, reserved, on_wait);
+        page_table_base = reserved[0]; 
+        if (virtual_time) {
+            clock = max(clock, admitted); // 等到有足够的页框空闲的时刻才能开始
+            shared_clock.store(clock, memory_order_relaxed);
+            if (preload) {
+                start_time = clock;
+            }
+        }
+        stats.admission_wait += now() - arrival;
+        if (global_stats) {
+            global_stats->record_occupancy(now(), needed);
+        }
+        if (allocation != AllocMode::FIXED) {
+            policy.resize(max(pages, 1)); // 按这次分到的槽位数调整，挂起前留下的历史还在
+        }
+        resident.dirty.assign(pages, 0);
+        for (int i = 0; i < pages; i++) { 
+            int frame = reserved[i + 1]; 
+            resident.frames.push_back(frame);
+            if (preload) {
+                page_table[i] = frame; // 更新页表
+                resident.page_slot[i] = i;
+                memory->write_page(frame, file.read_page(i)); 
+                policy.on_preload(i, i); // 预先装入的页面也要让替换算法知道
+            }
+            else {
+                memory->write_page(frame, Page(-1, -1));
+                empty_slots.push_back(i);
+            }
+        }
+        stats.max_resident = max(stats.max_resident, (long long)pages);
+        memory->write_page(page_table_base, Page(job_id, -1)); // 将页表的基地址写入内存
+        log(LogEventType::ALLOCATE, 0, 0, 0, Page(), needed); // 输出分配信息
+    }
+
+    // 释放内存，将进程占用的内存页面释放
+    void free_memory() {
+        vector<int>& frames = released;
+        frames.clear();
+        frames.push_back(page_table_base); // 页表占用的页面
+        frames.insert(frames.end(), resident.frames.begin(), resident.frames.end()); // 进程占用的页面
+        if (global_stats) { // 在真正释放之前记下时刻，免得晚于下一个作业占用页框
+            global_stats->record_occupancy(now(), -(int)frames.size());
+        }
+        memory->free_pages(frames, clock, virtual_time ? &shared_clock : nullptr); // 一次释放，唤醒等待的作业
+        if (pool) {
+            stats.stolen = pool->detach(job_id); // 之后其他作业不会再写这个文件
+        }
+        file.flush(); // 写回还暂存在文件里的页面
+        log(LogEventType::FREE, 0, 0, 0, Page(), frames.size()); // 输出释放信息
+        if (virtual_time) {
+            print_line("Job %d ran from virtual time %lld ms to %lld ms.", job_id, start_time, clock);
+        }
+    }
+
+    // 模拟进程的访问行为，根据访问列表或者轨迹文件访问内存中的页面
+    void access_memory() {
+        if (trace) {
+            const uint32_t* data;
+            size_t count;
+            while (trace->next(data, count)) { // 一块一块地读，读下一块的同时后台在预读
+                for (size_t i = 0; i < count; i++) {
+                    int address = (data[i] & ~TRACE_WRITE_BIT) % (VIRTUAL_PAGE_NUM * PAGE_SIZE); // 超出虚拟地址空间的地址折回来
+                    access(address, (data[i] & TRACE_WRITE_BIT) != 0);
+                }
+            }
+            return;
+        }
+        for (int i = 0; i < access_list.size(); i++) {
+            access(access_list[i], write_list[i]);
+        }
+    }
+
+    // 访问一个逻辑地址
+    void access(int address, bool write) {
+        int page = address / PAGE_SIZE; 
+        stats.accesses++;
+        long long faults = stats.faults;
+        int frame = pool ? access_shared(address, page, write) : access_local(address, page, write);
+        Page p = memory->read_page(frame); 
+        log(LogEventType::ACCESS, address, page, frame, p, 0, write); // 输出访问信息
+        if (allocation != AllocMode::FIXED) {
+            adjust_allocation(page, stats.faults != faults);
+        }
+        wait(rng.below(MAX_SLEEP_TIME)); // 随机休眠一段时间
+    }
+
+    // 局部置换：只在自己的页框中置换，返回页面所在的物理页框
+    int access_local(int address, int page, bool write) {
+        int frame = page_table[page];
+        if (frame == -1) { 
+            stats.faults++; 
+            log(LogEventType::FAULT, address, page); // 输出缺页中断信息
+            frame = page_replace(page); 
+        }
+        else { 
+            stats.hits++;
+            policy.on_access(page, resident.page_slot[page]); 
+        }
+        if (write) {
+            resident.dirty[resident.page_slot[page]] = 1; // 写操作，页面变脏
+        }
+        return frame;
+    }
+
+    // 全局置换：在共用的页框池中访问，缺页时可能换出其他作业的页面
+    int access_shared(int address, int page, bool write) {
+        long long begin = now();
+        PoolAccess result = pool->access(job_id, page, write);
+        if (!result.fault) {
+            stats.hits++;
+            return result.frame;
+        }
+        stats.faults++;
+        log(LogEventType::FAULT, address, page); // 输出缺页中断信息
+        if (result.evicted) {
+            stats.evictions++;
+        }
+        if (result.stole) {
+            stats.steals++;
+        }
+        if (result.wrote_back) {
+            stats.write_backs++;
+            advance_io();
+        }
+        advance_io();
+        stats.page_in.add(now() - begin);
+        if (result.evicted) {
+            log(LogEventType::REPLACE, 0, page, result.frame, result.old); // 输出置换信息
+        }
+        return result.frame;
+    }
+
+    // 经过 ms 毫秒：虚拟时间模式下只推进时钟，否则真的休眠
+    void wait(int ms) {
+        if (virtual_time) {
+            clock += ms;
+            shared_clock.store(clock, memory_order_relaxed);
+        }
+        else {
+            this_thread::sleep_for(chrono::milliseconds(ms));
+        }
+    }
+
+    // 页面置换算法，选出一个槽位装入 page，返回物理页框号
+    int page_replace(int page) {
+        long long begin = now();
+        int slot;
+        if (!empty_slots.empty()) { // 还有空槽位就不用换出
+            slot = empty_slots.back();
+            empty_slots.pop_back();
+        }
+        else {
+            slot = policy.choose_victim(page, resident); 
+        }
+        int frame = resident.frames[slot];
+        Page p = memory->read_page(frame); 
+        int old_page = p.get_page_id(); // 获取旧的页面号
+        if (old_page != -1) { 
+            stats.evictions++;
+            if (resident.dirty[slot]) {
+                file.write_page(old_page, p); // 脏页面写回文件
+                stats.write_backs++;
+                advance_io();
+            }
+            page_table[old_page] = -1; // 将对应的页表项置为无效
+            resident.page_slot[old_page] = -1;
+        }
+        resident.dirty[slot] = 0;
+        page_table[page] = frame; 
+        resident.page_slot[page] = slot;
+        memory->write_page(frame, file.read_page(page)); // 从文件中读取新的页面内容，写入内存
+        advance_io();
+        policy.on_load(page, slot);
+        stats.page_in.add(now() - begin);
+        if (old_page != -1) {
+            log(LogEventType::REPLACE, 0, page, frame, p); // 输出置换信息
+        }
+        return frame; 
+    }
+
+    // 动态分配：每次访问后按工作集大小或缺页频率决定常驻集合应有的页面数，然后扩大或缩小
+    // 想扩大却连续 SUSPEND_AFTER 次拿不到页框，并且有作业在排队，说明内存不够大家用，挂起自己让排队的作业准入
+    // 没有作业排队时挂起只会让自己换出再换入，保持当前大小继续运行
+    void adjust_allocation(int page, bool fault) {
+        last_ref[page] = stats.accesses;
+        int size = resident.frames.size();
+        int want = size;
+        if (allocation == AllocMode::WORKING_SET) {
+            int slot = stats.accesses % WS_WINDOW;
+            if (window[slot] != -1 && --window_count[window[slot]] == 0) {
+                ws_size--;
+            }
+            window[slot] = page;
+            if (window_count[page]++ == 0) {
+                ws_size++;
+            }
+            if (fault || slot == 0) { // 缺页时和每过一个窗口时调整
+                want = ws_size;
+            }
+        }
+        else if (fault) {
+            long long interval = stats.accesses - last_fault;
+            last_fault = stats.accesses;
+            if (interval < PFF_GROW_INTERVAL) {
+                want++;
+            }
+            else if (interval > PFF_SHRINK_INTERVAL) {
+                want--;
+            }
+        }
+        want = min(max(want, MIN_PROCESS_PAGE_NUM), MAX_PROCESS_PAGE_NUM);
+        if (want < size) {
+            shrink(want);
+        }
+        else if (want > size) {
+            if (grow(want)) {
+                failed_growth = 0;
+            }
+            else if (++failed_growth >= SUSPEND_AFTER && memory->has_waiters()) {
+                failed_growth = 0;
+                suspend(want);
+            }
+        }
+    }
+
+    // 从内存取空闲页框扩大常驻集合到 n 个槽位，新槽位先空着；拿够了返回 true
+    bool grow(int n) {
+        int got = 0;
+        while (resident.frames.size() < n) {
+            int frame = memory->try_allocate_page(virtual_time ? clock : LLONG_MAX);
+            if (frame == -1) {
+                break;
+            }
+            memory->write_page(frame, Page(-1, -1));
+            empty_slots.push_back(resident.frames.size());
+            resident.frames.push_back(frame);
+            resident.dirty.push_back(0);
+            got++;
+        }
+        if (got) {
+            if (global_stats) {
+                global_stats->record_occupancy(now(), got);
+            }
+            stats.max_resident = max(stats.max_resident, (long long)resident.frames.size());
+            policy.resize(resident.frames.size());
+        }
+        return resident.frames.size() >= n;
+    }
+
+    // 缩小常驻集合到 n 个槽位：先去掉空槽位，再换出最久没有访问的页面，页框还给内存
+    void shrink(int n) {
+        released.clear();
+        while (resident.frames.size() > n) {
+            int slot = -1;
+            if (!empty_slots.empty()) {
+                slot = empty_slots.back();
+                empty_slots.pop_back();
+            }
+            else {
+                for (int s = 0; s < resident.frames.size(); s++) {
+                    if (slot == -1 || last_ref[page_in_slot(s)] < last_ref[page_in_slot(slot)]) {
+                        slot = s;
+                    }
+                }
+                page_out(slot);
+                stats.evictions++;
+            }
+            int last = resident.frames.size() - 1; // 把最后一个槽位挪到空出来的位置，槽位保持连续
+            released.push_back(resident.frames[slot]);
+            if (slot != last) {
+                int moved = page_in_slot(last);
+                resident.frames[slot] = resident.frames[last];
+                resident.dirty[slot] = resident.dirty[last];
+                if (moved != -1) {
+                    resident.page_slot[moved] = slot;
+                    policy.on_move(moved, last, slot);
+                }
+                replace(empty_slots.begin(), empty_slots.end(), last, slot);
+            }
+            resident.frames.pop_back();
+            resident.dirty.pop_back();
+        }
+        if (global_stats) {
+            global_stats->record_occupancy(now(), -(int)released.size());
+        }
+        memory->free_pages(released, clock);
+        policy.resize(resident.frames.size());
+    }
+
+    // 挂起：写回脏页面，释放全部页框，重新排队等到 pages 个页面的页框，回来以后页面缺页时再装入
+    void suspend(int pages) {
+        vector<int>& frames = released;
+        frames.clear();
+        frames.push_back(page_table_base);
+        for (int slot = 0; slot < resident.frames.size(); slot++) {
+            if (page_in_slot(slot) != -1) {
+                page_out(slot);
+            }
+            frames.push_back(resident.frames[slot]);
+        }
+        resident.frames.clear();
+        resident.dirty.clear();
+        empty_slots.clear();
+        stats.suspensions++;
+        log(LogEventType::SUSPEND, 0, 0, 0, Page(), frames.size());
+        if (global_stats) {
+            global_stats->record_occupancy(now(), -(int)frames.size());
+        }
+        memory->free_pages(frames, clock, virtual_time ? &shared_clock : nullptr); // 唤醒排队的作业
+        admit(pages, false);
+    }
+
+    // 槽位中的页面号，空槽位是 -1
+    int page_in_slot(int slot) {
+        return memory->read_page(resident.frames[slot]).get_page_id();
+    }
+
+    // 把槽位中的页面换出，脏页面写回文件，替换算法中去掉这个页面
+    void page_out(int slot) {
+        int frame = resident.frames[slot];
+        Page p = memory->read_page(frame);
+        if (resident.dirty[slot]) {
+            file.write_page(p.get_page_id(), p);
+            stats.write_backs++;
+            advance_io();
+        }
+        page_table[p.get_page_id()] = -1;
+        resident.page_slot[p.get_page_id()] = -1;
+        resident.dirty[slot] = 0;
+        memory->write_page(frame, Page(-1, -1));
+        policy.on_remove(p.get_page_id(), slot);
+    }
+
+    // 把事件交给异步日志，级别没打开的事件不构造记录
+    void log(LogEventType type, int address = 0, int page = 0, int frame = 0, const Page& content = Page(), int count = 0, bool write = false) {
+        if (!logger || !logger->enabled(type)) {
+            return;
+        }
+        LogEvent event;
+        event.type = (uint8_t)type;
+        event.write = write;
+        event.reserved = 0;
+        event.job_id = job_id;
+        event.address = address;
+        event.page = page;
+        event.frame = frame;
+        event.content_job = content.get_job_id();
+        event.content_page = content.get_page_id();
+        event.count = count;
+        logger->log(event);
+    }
+
+    // 统计用的当前时刻，微秒：虚拟时间模式下是虚拟时钟，否则是真实时间
+    long long now() const {
+        if (virtual_time) {
+            return clock * 1000;
+        }
+        return global_stats ? global_stats->elapsed() : chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 进程结束时把统计交给全局汇总
+    void report_stats() {
+        if (global_stats) {
+            global_stats->add(stats);
+        }
+    }
+
+    // 虚拟时间模式下一次磁盘读写花 DISK_IO_TIME；真实模式下读写本身就花了时间
+    void advance_io() {
+        if (virtual_time) {
+            clock += DISK_IO_TIME;
+            shared_clock.store(clock, memory_order_relaxed);
+        }
+    }
+
+    // 访问序列中每次访问的页面号，放在 page_list 里复用
+    const vector<int>& access_pages() {
+        page_list.resize(access_list.size());
+        for (int i = 0; i < access_list.size(); i++) {
+            page_list[i] = access_list[i] / PAGE_SIZE;
+        }
+        return page_list;
+    }
+
+    //缺页中断率，同时给出同一访问序列下 OPT 的缺页中断率作为下界（轨迹模式下没有完整的访问序列，不给出）
+    void print_page_fault_rate() {
+        double rate = stats.fault_rate(); 
+        if (trace || pool || allocation != AllocMode::FIXED) { // 全局置换和动态分配时作业的页框数不固定，没有可比的下界
+            print_line("The page fault rate of job %d is %g (%s)", job_id, rate, Policy::name());
+            return;
+        }
+        if (preloaded.empty()) {
+            for (int i = 0; i < PROCESS_PAGE_NUM; i++) {
+                preloaded.push_back(i); // 和 allocate_memory 一样预先装入前 PROCESS_PAGE_NUM 个页面
+            }
+        }
+        double opt_rate = (double)bound.count_faults(access_pages(), PROCESS_PAGE_NUM, preloaded, VIRTUAL_PAGE_NUM) / stats.accesses;
+        print_line("The page fault rate of job %d is %g (%s), OPT lower bound %g", job_id, rate, Policy::name(), opt_rate);
+    }
+};
+
+
+
+// 对象池：用完的对象不析构，放回池里，下次取出时由使用者原地重置，对象里缓冲区的容量留着接着用
+// 不加锁，每个工作线程各用一个
+template <class T>
+class ObjectPool {
+private:
+    vector<unique_ptr<T>> idle; // 用完放回来的对象
+public:
+    // 从池里借出的对象，离开作用域时自动还回池里
+    class Handle {
+    private:
+        ObjectPool* pool;
+        unique_ptr<T> object;
+    public:
+        Handle(ObjectPool* pool, unique_ptr<T> object) : pool(pool), object(move(object)) {}
+
+        Handle(Handle&& other) = default;
+        Handle& operator=(Handle&&) = delete;
+
+        ~Handle() {
+            if (object) {
+                pool->idle.push_back(move(object));
+            }
+        }
+
+        T& operator*() const {
+            return *object;
+        }
+
+        T* operator->() const {
+            return object.get();
+        }
+    };
+
+    // 池里有用过的对象就取一个，没有才新建
+    Handle acquire() {
+        if (idle.empty()) {
+            return Handle(this, unique_ptr<T>(new T()));
+        }
+        unique_ptr<T> object = move(idle.back());
+        idle.pop_back();
+        return Handle(this, move(object));
+    }
+};
+
+// 创建并运行一个进程，每个替换算法实例化一份
+// 进程对象从当前工作线程的对象池里取，作业结束后还回去给这个线程的下一个作业用，稳定运行时不再分配内存
+template <class Policy>
+void run_process(int job_id, Memory* memory, const SimConfig& config) {
+    static thread_local ObjectPool<Process<Policy>> processes;
+    typename ObjectPool<Process<Policy>>::Handle process = processes.acquire();
+    process->start(job_id, memory, config);
+    process->access_memory(); // 模拟进程访问
+    process->print_page_fault_rate(); 
+    process->free_memory(); 
+    process->report_stats();
+    process->finish();
+}
+
+typedef void (*ProcessRunner)(int job_id, Memory* memory, const SimConfig& config);
+typedef void (*JobsRunner)(int n, Memory* memory, const SimConfig& config);
+
+// 模拟作业创建运行，只有几个字段，按值放在工作线程的队列里
+class Job {
+private:
+    int job_id = -1; 
+    Memory* memory = nullptr;
+    ProcessRunner runner = nullptr; // 按替换算法实例化好的进程运行函数
+    const SimConfig* config = nullptr;
+public:
+    Job() {}
+
+    Job(int job_id, Memory* memory, ProcessRunner runner, const SimConfig* config) {
+        this->job_id = job_id;
+        this->memory = memory;
+        this->runner = runner;
+        this->config = config;
+    }
+
+    // 创建并运行进程
+    void run() {
+        runner(job_id, memory, *config);
+    }
+};
+
+// 工作线程池：每个工作线程有自己的作业队列，自己的队列空了就从其他线程的队尾窃取作业
+// ordered 时所有作业放在一个队列里，严格按提交顺序取出：虚拟时间下作业按作业号准入，
+// 作业号小的作业必须先被某个工作线程取走，否则排在后面的作业会一直等它
+class WorkerPool {
+private:
+    // 作业按值放在数组里，[head, jobs.size()) 是还没运行的；队首从 head 取，窃取从末尾取
+    struct WorkQueue {
+        vector<Job> jobs;
+        size_t head = 0;
+        mutex mtx; // 保护 jobs 和 head
+    };
+    vector<unique_ptr<WorkQueue>> queues; // 每个工作线程一个队列
+    bool ordered; // 只用 0 号队列，不窃取
+public:
+    // jobs 是预计提交的作业总数，事先留好每个队列的空间
+    WorkerPool(int workers, int jobs = 0, bool ordered = false) : ordered(ordered) {
+        if (workers < 1) {
+            workers = 1;
+        }
+        for (int i = 0; i < workers; i++) {
+            queues.push_back(unique_ptr<WorkQueue>(new WorkQueue()));
+            queues.back()->jobs.reserve(ordered ? (i == 0 ? jobs : 0) : (jobs + workers - 1) / workers);
+        }
+    }
+
+    int size() const {
+        return queues.size();
+    }
+
+    // 把作业放入指定工作线程的队列
+    void submit(int worker, const Job& job) {
+        WorkQueue& q = *queues[ordered ? 0 : worker % queues.size()];
+        lock_guard<mutex> lock(q.mtx);
+        q.jobs.push_back(job);
+    }
+
+    // 启动所有工作线程，直到所有作业运行完毕才返回
+    void run() {
+        vector<thread> threads;
+        for (int i = 1; i < queues.size(); i++) {
+            threads.emplace_back(&WorkerPool::work, this, i);
+        }
+        work(0); // 主线程也作为 0 号工作线程
+        for (int i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+    }
+
+private:
+    // 先从自己的队首取作业，取不到再依次从其他线程的队尾窃取
+    bool take(int worker, Job& job) {
+        {
+            WorkQueue& own = *queues[ordered ? 0 : worker];
+            lock_guard<mutex> lock(own.mtx);
+            if (own.head < own.jobs.size()) {
+                job = own.jobs[own.head++];
+                return true;
+            }
+        }
+        for (int i = 1; i < queues.size() && !ordered; i++) {
+            WorkQueue& victim = *queues[(worker + i) % queues.size()];
+            lock_guard<mutex> lock(victim.mtx);
+            if (victim.head < victim.jobs.size()) {
+                job = victim.jobs.back();
+                victim.jobs.pop_back();
+                return true;
+            }
+        }
+        return false; // 作业都在 run() 之前提交，所有队列都空说明没有作业了
+    }
+
+    void work(int worker) {
+        Job job;
+        while (take(worker, job)) {
+            job.run();
+        }
+    }
+};
+
+// 用 Policy 运行 n 个作业，config.workers 个工作线程并行运行；全局置换模式下先创建共用的页框池
+template <class Policy>
+void run_policy_jobs(int n, Memory* memory, const SimConfig& config) {
+    SimConfig run_config = config;
+    unique_ptr<GlobalPool<Policy>> pool;
+    if (config.global_replacement) {
+        int tables = min(n, max(config.workers, 1)); // 同时运行的作业各要一个页表页框，其余都放进池里
+        int size = memory->get_free_count() - tables;
+        if (size < 1) {
+            cout << "Not enough frames for a global frame pool." << endl;
+            return;
+        }
+        pool.reset(new GlobalPool<Policy>(memory, size, n));
+        run_config.pool = pool.get();
+    }
+    WorkerPool workers(config.workers, n, config.virtual_time); // 虚拟时间下按作业号依次取作业，见 Memory::reserve_pages_at
+    for (int i = 0; i < n; i++) { // 创建 n 个作业，轮流分给各个工作线程
+        workers.submit(i, Job(i, memory, run_process<Policy>, &run_config));
+    }
+    workers.run();
+}
+
+// 支持的页面替换算法，按名字对应到实例化好的运行函数
+extern const vector<pair<string, JobsRunner>> POLICIES;
+
+// 按名字找替换算法，找不到返回 nullptr
+JobsRunner find_policy(const string& algorithm);
+
+bool valid_algorithm(const string& algorithm);
+
+//运行多个作业，config.workers 个工作线程并行运行
+void run_jobs(int n, Memory* memory, const SimConfig& config);
+
+// 分析模式：不运行作业，只扫一遍每个作业的访问序列，输出 LRU 在每个页框数下的缺页次数，CSV 格式
+void run_mrc(int n, const SimConfig& config, ostream& out);
+
+// 分析模式：SHARDS 抽样估计每个作业的缺页率曲线，rate 是初始抽样率，最多同时跟踪 max_pages 个抽样页面
+void run_shards(int n, const SimConfig& config, double rate, int max_pages, ostream& out);
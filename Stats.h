@@ -0,0 +1,255 @@
+#pragma once
+
+#include "MyFt.h"
+
+// 模拟统计
+// 每个进程在自己的 ProcessStats 里计数，不和其他线程共享；进程结束时一次交给 Stats 汇总
+// 时间都用微秒：虚拟时间模式下是虚拟时钟，否则是从开始运行算起的真实时间
+
+// 延迟直方图，第 i 个桶统计小于 2^i 微秒、不小于 2^(i-1) 微秒的样本，最后一个桶收下所有更大的
+struct LatencyHistogram {
+    static const int BUCKETS = 32;
+    long long counts[BUCKETS] = {};
+    long long count = 0;
+    long long total = 0; // 微秒
+    long long max = 0;
+
+    void add(long long us) {
+        int i = 0;
+        while (i < BUCKETS - 1 && us >= (1LL << i)) {
+            i++;
+        }
+        counts[i]++;
+        count++;
+        total += us;
+        max = std::max(max, us);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) {
+            counts[i] += other.counts[i];
+        }
+        count += other.count;
+        total += other.total;
+        max = std::max(max, other.max);
+    }
+
+    // 第 i 个桶的上界（不含）
+    static long long bound(int i) {
+        return 1LL << i;
+    }
+
+    // 估计分位数：返回第一个累计数达到 q 的桶的上界，不超过最大值
+    long long percentile(double q) const {
+        long long need = (long long)ceil(q * count);
+        long long seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= need && seen > 0) {
+                return min(bound(i), max);
+            }
+        }
+        return max;
+    }
+
+    double mean() const {
+        return count ? (double)total / count : 0;
+    }
+};
+
+struct ProcessStats {
+    int job_id = 0;
+    string policy;
+    long long accesses = 0;
+    long long hits = 0;
+    long long faults = 0;
+    long long evictions = 0; // 换出了一个页面的缺页（第一次装入空槽位不算）
+    long long write_backs = 0; // 换出时写回文件的脏页面
+    long long steals = 0; // 全局置换时换出了其他正在运行的作业的页面的次数
+    long long stolen = 0; // 全局置换时自己的页面被其他作业换出的次数
+    long long suspensions = 0; // 动态分配时因为抖动被挂起的次数
+    long long max_resident = 0; // 常驻集合最多时的页面数
+    long long admission_wait = 0; // 等待内存准入的时间，包括挂起后重新准入，微秒
+    LatencyHistogram page_in; // 一次缺页从选出牺牲页面到新页面装入的时间，包括写回
+
+    void merge(const ProcessStats& other) {
+        accesses += other.accesses;
+        hits += other.hits;
+        faults += other.faults;
+        evictions += other.evictions;
+        write_backs += other.write_backs;
+        steals += other.steals;
+        stolen += other.stolen;
+        suspensions += other.suspensions;
+        max_resident = max(max_resident, other.max_resident);
+        admission_wait += other.admission_wait;
+        page_in.merge(other.page_in);
+    }
+
+    double fault_rate() const {
+        return accesses ? (double)faults / accesses : 0;
+    }
+};
+
+class Stats {
+private:
+    mutex mtx; // 保护下面的成员，进程只在分配、释放内存和结束时各用一次
+    vector<ProcessStats> processes;
+    vector<pair<long long, int>> occupancy_changes; // (时刻, 占用页框数的变化)，导出时再按时刻排序累加
+    chrono::steady_clock::time_point start;
+    int frames; // 物理页框总数
+public:
+    Stats(int frames) : start(chrono::steady_clock::now()), frames(frames) {}
+
+    Stats(const Stats&) = delete;
+    Stats& operator=(const Stats&) = delete;
+
+    // 从开始运行算起的真实时间，微秒
+    long long elapsed() const {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+    // 在 time 时刻占用（n > 0）或释放（n < 0）了 n 个页框
+    void record_occupancy(long long time, int n) {
+        lock_guard<mutex> lock(mtx);
+        occupancy_changes.push_back(make_pair(time, n));
+    }
+
+    void add(const ProcessStats& s) {
+        lock_guard<mutex> lock(mtx);
+        processes.push_back(s);
+    }
+
+    // 按作业号排好序的各进程统计
+    vector<ProcessStats> process_stats() {
+        lock_guard<mutex> lock(mtx);
+        vector<ProcessStats> out = processes;
+        sort(out.begin(), out.end(), [](const ProcessStats& a, const ProcessStats& b) { return a.job_id < b.job_id; });
+        return out;
+    }
+
+    ProcessStats total() {
+        vector<ProcessStats> all = process_stats();
+        ProcessStats sum;
+        sum.job_id = -1;
+        for (int i = 0; i < all.size(); i++) {
+            sum.merge(all[i]);
+            sum.policy = all[i].policy;
+        }
+        return sum;
+    }
+
+    // 页框占用随时间的变化：(时刻, 变化之后占用的页框数)，同一时刻的变化合成一个点
+    vector<pair<long long, int>> occupancy() {
+        vector<pair<long long, int>> changes;
+        {
+            lock_guard<mutex> lock(mtx);
+            changes = occupancy_changes;
+        }
+        sort(changes.begin(), changes.end());
+        vector<pair<long long, int>> out;
+        int used = 0;
+        for (int i = 0; i < changes.size(); i++) {
+            used += changes[i].second;
+            if (!out.empty() && out.back().first == changes[i].first) {
+                out.back().second = used;
+            }
+            else {
+                out.push_back(make_pair(changes[i].first, used));
+            }
+        }
+        return out;
+    }
+
+    bool write_json(const string& path) {
+        ofstream ofs(path);
+        if (!ofs.is_open()) {
+            return false;
+        }
+        vector<ProcessStats> all = process_stats();
+        ofs << "{\n  \"frames\": " << frames << ",\n  \"processes\": [\n";
+        for (int i = 0; i < all.size(); i++) {
+            ofs << "    ";
+            json_process(ofs, all[i]);
+            ofs << (i + 1 < all.size() ? ",\n" : "\n");
+        }
+        ofs << "  ],\n  \"total\": ";
+        json_process(ofs, total());
+        ofs << ",\n  \"occupancy\": [";
+        vector<pair<long long, int>> points = occupancy();
+        for (int i = 0; i < points.size(); i++) {
+            ofs << (i ? ", " : "") << "[" << points[i].first << ", " << points[i].second << "]";
+        }
+        ofs << "]\n}\n";
+        return true;
+    }
+
+    // 每个进程一行，最后一行 job 为 total 的是汇总；直方图每个桶一列
+    bool write_csv(const string& path) {
+        ofstream ofs(path);
+        if (!ofs.is_open()) {
+            return false;
+        }
+        ofs << "job,policy,accesses,hits,faults,evictions,write_backs,steals,stolen,suspensions,max_resident,fault_rate,admission_wait_us,"
+            << "page_in_mean_us,page_in_p50_us,page_in_p99_us,page_in_max_us";
+        for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+            ofs << ",page_in_lt_" << LatencyHistogram::bound(i) << "us";
+        }
+        ofs << "\n";
+        vector<ProcessStats> all = process_stats();
+        for (int i = 0; i < all.size(); i++) {
+            ofs << all[i].job_id;
+            csv_row(ofs, all[i]);
+        }
+        ofs << "total";
+        csv_row(ofs, total());
+        return true;
+    }
+
+    // 页框占用的时间线，每行 "时刻,占用页框数"
+    bool write_occupancy_csv(const string& path) {
+        ofstream ofs(path);
+        if (!ofs.is_open()) {
+            return false;
+        }
+        ofs << "time_us,used_frames\n";
+        vector<pair<long long, int>> points = occupancy();
+        for (int i = 0; i < points.size(); i++) {
+            ofs << points[i].first << "," << points[i].second << "\n";
+        }
+        return true;
+    }
+
+private:
+    static void json_process(ostream& os, const ProcessStats& s) {
+        os << "{";
+        if (s.job_id >= 0) {
+            os << "\"job\": " << s.job_id << ", ";
+        }
+        os << "\"policy\": \"" << s.policy << "\", \"accesses\": " << s.accesses << ", \"hits\": " << s.hits
+           << ", \"faults\": " << s.faults << ", \"evictions\": " << s.evictions << ", \"write_backs\": " << s.write_backs
+           << ", \"steals\": " << s.steals << ", \"stolen\": " << s.stolen
+           << ", \"suspensions\": " << s.suspensions << ", \"max_resident\": " << s.max_resident << ", \"fault_rate\": " << s.fault_rate() << ", \"admission_wait_us\": " << s.admission_wait
+           << ", \"page_in_us\": {\"count\": " << s.page_in.count << ", \"mean\": " << s.page_in.mean()
+           << ", \"p50\": " << s.page_in.percentile(0.5) << ", \"p99\": " << s.page_in.percentile(0.99)
+           << ", \"max\": " << s.page_in.max << ", \"buckets\": [";
+        bool first = true;
+        for (int i = 0; i < LatencyHistogram::BUCKETS; i++) { // 只写出非空的桶
+            if (s.page_in.counts[i]) {
+                os << (first ? "" : ", ") << "{\"lt\": " << LatencyHistogram::bound(i) << ", \"count\": " << s.page_in.counts[i] << "}";
+                first = false;
+            }
+        }
+        os << "]}}";
+    }
+
+    static void csv_row(ostream& os, const ProcessStats& s) {
+        os << "," << s.policy << "," << s.accesses << "," << s.hits << "," << s.faults << "," << s.evictions << ","
+           << s.write_backs << "," << s.steals << "," << s.stolen << "," << s.suspensions << "," << s.max_resident << "," << s.fault_rate() << "," << s.admission_wait << "," << s.page_in.mean() << ","
+           << s.page_in.percentile(0.5) << "," << s.page_in.percentile(0.99) << "," << s.page_in.max;
+        for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+            os << "," << s.page_in.counts[i];
+        }
+        os << "\n";
+    }
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "MyFt.h"
+
+// 访问轨迹文件
+// 二进制格式：文件头 TraceHeader，之后每次访问一个 uint32_t，最高位是写标记，低 31 位是逻辑地址
+// 文本格式：每行一次访问，"<逻辑地址> [R|W]"，不写读写标记按读处理，# 开头的行是注释
+// 作业 i 的轨迹文件是 <前缀>i.bin，没有的话再找 <前缀>i.txt
+
+struct TraceHeader {
+    char magic[8]; // TRACE_MAGIC
+    uint32_t version; // TRACE_VERSION
+    uint32_t reserved;
+};
+
+const char TRACE_MAGIC[8] = {'M', 'F', 'T', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t TRACE_VERSION = 1;
+const uint32_t TRACE_WRITE_BIT = 1u << 31; // 访问记录中的写标记
+const int TRACE_CHUNK = 1 << 16; // 每次读入的访问记录数
+
+// 把一次访问编码成一条记录
+inline uint32_t encode_access(int address, bool write) {
+    return ((uint32_t)address & ~TRACE_WRITE_BIT) | (write ? TRACE_WRITE_BIT : 0);
+}
+
+// 流式读取轨迹文件：后台线程预读，两个定长缓冲区轮流使用，内存占用和轨迹长度无关
+class TraceReader {
+private:
+    FILE* fp = nullptr;
+    bool binary = false;
+    vector<uint32_t> buffers[2];
+    bool ready[2] = {false, false}; // 缓冲区已经填好，等待消费
+    bool done = false; // 后台线程已经读到文件末尾
+    bool stop = false; // 析构时通知后台线程退出
+    bool holding = false; // 使用者还拿着上一次返回的缓冲区
+    int consume = 0; // 下一个要交给使用者的缓冲区
+    mutex mtx;
+    condition_variable cv;
+    thread worker;
+public:
+    TraceReader(const string& path) {
+        fp = fopen(path.c_str(), "rb");
+        if (!fp) {
+            return;
+        }
+        TraceHeader header;
+        if (fread(&header, sizeof(header), 1, fp) == 1 && memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) {
+            binary = true;
+            if (header.version != TRACE_VERSION) {
+                cerr << path << " has unsupported trace version " << header.version << endl;
+                fclose(fp);
+                fp = nullptr;
+                return;
+            }
+        }
+        else {
+            rewind(fp); // 不是二进制格式，按文本读
+        }
+        buffers[0].reserve(TRACE_CHUNK);
+        buffers[1].reserve(TRACE_CHUNK);
+        worker = thread(&TraceReader::read_ahead, this);
+    }
+
+    ~TraceReader() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        if (fp) {
+            fclose(fp);
+        }
+    }
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool is_open() const {
+        return fp != nullptr;
+    }
+
+    // 按前缀和作业号找轨迹文件，先找二进制格式
+    static string path_for(const string& prefix, int job_id) {
+        string path = prefix + to_string(job_id) + ".bin";
+        if (access(path.c_str(), R_OK) == 0) {
+            return path;
+        }
+        return prefix + to_string(job_id) + ".txt";
+    }
+
+    // 取下一块访问记录，读完返回 false；返回的数据在下一次调用 next 之前有效
+    bool next(const uint32_t*& data, size_t& count) {
+        unique_lock<mutex> lock(mtx);
+        if (holding) { // 把上一块还给后台线程继续预读
+            ready[consume ^ 1] = false;
+            holding = false;
+            cv.notify_all();
+        }
+        cv.wait(lock, [this] { return ready[consume] || done; });
+        if (!ready[consume]) {
+            return false;
+        }
+        data = buffers[consume].data();
+        count = buffers[consume].size();
+        holding = true;
+        consume ^= 1;
+        return true;
+    }
+
+private:
+    // 后台线程：依次填两个缓冲区，使用者还没取走时等待
+    void read_ahead() {
+        int fill = 0;
+        for (;;) {
+            {
+                unique_lock<mutex> lock(mtx);
+                cv.wait(lock, [this, fill] { return !ready[fill] || stop; });
+                if (stop) {
+                    return;
+                }
+            }
+            vector<uint32_t>& buf = buffers[fill];
+            buf.clear();
+            if (binary) {
+                buf.resize(TRACE_CHUNK);
+                buf.resize(fread(buf.data(), sizeof(uint32_t), TRACE_CHUNK, fp));
+            }
+            else {
+                read_text(buf);
+            }
+            lock_guard<mutex> lock(mtx);
+            if (buf.empty()) {
+                done = true;
+                cv.notify_all();
+                return;
+            }
+            ready[fill] = true;
+            cv.notify_all();
+            fill ^= 1;
+        }
+    }
+
+    void read_text(vector<uint32_t>& buf) {
+        char line[128];
+        while (buf.size() < TRACE_CHUNK && fgets(line, sizeof(line), fp)) {
+            long long address;
+            char op = 'R';
+            if (line[0] == '#' || sscanf(line, "%lld %c", &address, &op) < 1) {
+                continue;
+            }
+            buf.push_back(encode_access((int)(address & ~TRACE_WRITE_BIT), op == 'W' || op == 'w'));
+        }
+    }
+};
+
+// 写二进制轨迹文件
+class TraceWriter {
+private:
+    FILE* fp;
+public:
+    TraceWriter(const string& path) {
+        fp = fopen(path.c_str(), "wb");
+        if (fp) {
+            TraceHeader header;
+            memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+            header.version = TRACE_VERSION;
+            header.reserved = 0;
+            fwrite(&header, sizeof(header), 1, fp);
+        }
+    }
+
+    ~TraceWriter() {
+        if (fp) {
+            fclose(fp);
+        }
+    }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool is_open() const {
+        return fp != nullptr;
+    }
+
+    void append(const uint32_t* records, size_t count) {
+        if (fp) {
+            fwrite(records, sizeof(uint32_t), count, fp);
+        }
+    }
+
+    // 把任意格式的轨迹文件流式转换成二进制格式
+    static bool convert(const string& from, const string& to) {
+        TraceReader reader(from);
+        TraceWriter writer(to);
+        if (!reader.is_open() || !writer.is_open()) {
+            return false;
+        }
+        const uint32_t* data;
+        size_t count;
+        while (reader.next(data, count)) {
+            writer.append(data, count);
+        }
+        return true;
+    }
+};
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "MyFt.h"
+
+// 访问序列生成器，页面号覆盖整个虚拟地址空间 [0, VIRTUAL_PAGE_NUM)
+// 描述串的格式（命令行 --workload）：
+//   zipf[:s]            第 i 号页面的访问概率正比于 1/(i+1)^s，默认 s = 0.5，也就是 1/(i+1)^(1/2)
+//   scan                从 0 号页面顺序扫到最后一个页面，扫完再从头开始
+//   loop[:n]            反复顺序访问 0 .. n-1 号页面，默认 n = LOOP_PAGES
+//   phases[:n[:len]]    每 len 次访问换一个阶段，每个阶段在随机位置上的 n 个连续页面中均匀访问
+//   mix:w*描述+w*描述    每次访问按权重 w 选一个组成部分，由它给出页面，例如 mix:0.8*zipf:1+0.2*scan
+// 随机数发生器 G 每次调用返回一个 64 位的随机数
+
+const int LOOP_PAGES = 2 * PROCESS_PAGE_NUM; // loop 默认的循环长度，比分到的页框多，LRU 和 FIFO 会每次缺页
+const int PHASE_PAGES = PROCESS_PAGE_NUM; // phases 默认每个阶段的页面数，正好装得下
+const int PHASE_LENGTH = 50; // phases 默认每个阶段的访问次数
+const int WORKLOAD_BATCH = 1 << 12; // 批量生成时每批的访问数
+
+// [0, n) 上均匀的整数，用 32 位随机数的乘法代替取模
+inline uint32_t uniform_below(uint32_t r, uint32_t n) {
+    return (uint32_t)(((uint64_t)r * n) >> 32);
+}
+
+// Walker / Vose 别名表：任意离散分布 O(n) 建表，每次抽样 O(1)，只用一个 64 位随机数
+class AliasTable {
+private:
+    vector<uint64_t> prob; // 第 i 列留给自己的概率，按 2^32 放大
+    vector<uint32_t> alias; // 第 i 列剩下的概率给谁
+public:
+    AliasTable() {}
+
+    AliasTable(const vector<double>& weights) : prob(weights.size()), alias(weights.size()) {
+        int n = weights.size();
+        double sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += weights[i];
+        }
+        vector<double> scaled(n);
+        vector<int> small, large;
+        small.reserve(n);
+        large.reserve(n);
+        for (int i = 0; i < n; i++) {
+            scaled[i] = weights[i] * n / sum;
+            alias[i] = i;
+            (scaled[i] < 1 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) { // 小的列用一个大的列补满
+            int s = small.back(), l = large.back();
+            small.pop_back();
+            prob[s] = (uint64_t)(scaled[s] * 4294967296.0);
+            alias[s] = l;
+            scaled[l] -= 1 - scaled[s];
+            if (scaled[l] < 1) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        for (int i = 0; i < small.size(); i++) { // 剩下的只差浮点误差，都算满的
+            prob[small[i]] = 1ULL << 32;
+        }
+        for (int i = 0; i < large.size(); i++) {
+            prob[large[i]] = 1ULL << 32;
+        }
+    }
+
+    int size() const {
+        return prob.size();
+    }
+
+    // 高 32 位选列，低 32 位决定取这一列自己还是别名
+    int sample(uint64_t r) const {
+        uint32_t i = uniform_below((uint32_t)(r >> 32), prob.size());
+        return (uint32_t)r < prob[i] ? i : alias[i];
+    }
+};
+
+enum class WorkloadKind { ZIPF, SCAN, LOOP, PHASES, MIX };
+
+struct WorkloadSpec {
+    WorkloadKind kind = WorkloadKind::ZIPF;
+    double exponent = 0.5; // ZIPF
+    int pages = 0; // LOOP 的循环长度、PHASES 每个阶段的页面数
+    int phase_length = PHASE_LENGTH; // PHASES
+    vector<pair<double, WorkloadSpec>> parts; // MIX 的组成部分和权重
+
+    bool operator==(const WorkloadSpec& other) const {
+        return kind == other.kind && exponent == other.exponent && pages == other.pages
+            && phase_length == other.phase_length && parts == other.parts;
+    }
+
+    bool operator!=(const WorkloadSpec& other) const {
+        return !(*this == other);
+    }
+
+    // 解析描述串，格式不对返回 false
+    static bool parse(const string& text, WorkloadSpec& spec) {
+        spec = WorkloadSpec();
+        vector<string> fields;
+        size_t colon = text.find(':');
+        string name = text.substr(0, colon);
+        string rest = colon == string::npos ? "" : text.substr(colon + 1);
+        if (name == "mix") {
+            spec.kind = WorkloadKind::MIX;
+            size_t begin = 0;
+            while (begin <= rest.size()) {
+                size_t end = rest.find('+', begin);
+                if (end == string::npos) {
+                    end = rest.size();
+                }
+                string part = rest.substr(begin, end - begin);
+                size_t star = part.find('*');
+                WorkloadSpec sub;
+                char* stop;
+                double weight = star == string::npos ? 0 : strtod(part.c_str(), &stop);
+                if (star == string::npos || stop != part.c_str() + star || !(weight > 0)
+                    || !parse(part.substr(star + 1), sub) || sub.kind == WorkloadKind::MIX) {
+                    return false;
+                }
+                spec.parts.push_back(make_pair(weight, sub));
+                begin = end + 1;
+            }
+            return !spec.parts.empty();
+        }
+        size_t begin = 0;
+        while (colon != string::npos && begin <= rest.size()) {
+            size_t end = rest.find(':', begin);
+            if (end == string::npos) {
+                end = rest.size();
+            }
+            fields.push_back(rest.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        if (name == "zipf" && fields.size() <= 1) {
+            spec.kind = WorkloadKind::ZIPF;
+            return fields.empty() || (parse_number(fields[0], spec.exponent) && spec.exponent >= 0);
+        }
+        if (name == "scan" && fields.empty()) {
+            spec.kind = WorkloadKind::SCAN;
+            return true;
+        }
+        if (name == "loop" && fields.size() <= 1) {
+            spec.kind = WorkloadKind::LOOP;
+            spec.pages = LOOP_PAGES;
+            return fields.empty() || parse_pages(fields[0], spec.pages);
+        }
+        if (name == "phases" && fields.size() <= 2) {
+            spec.kind = WorkloadKind::PHASES;
+            spec.pages = PHASE_PAGES;
+            double length = PHASE_LENGTH;
+            if ((fields.size() >= 1 && !parse_pages(fields[0], spec.pages))
+                || (fields.size() >= 2 && (!parse_number(fields[1], length) || length < 1))) {
+                return false;
+            }
+            spec.phase_length = (int)length;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static bool parse_number(const string& text, double& value) {
+        char* stop;
+        value = strtod(text.c_str(), &stop);
+        return !text.empty() && *stop == '\0';
+    }
+
+    static bool parse_pages(const string& text, int& pages) {
+        double value;
+        if (!parse_number(text, value) || value < 1 || value > VIRTUAL_PAGE_NUM) {
+            return false;
+        }
+        pages = (int)value;
+        return true;
+    }
+};
+
+// 按 WorkloadSpec 生成页面号，scan、loop 的位置和 phases 的当前阶段是生成器的状态，连续生成时接着上一次
+// 建别名表要分配内存，进程对象复用时保留生成器，只用 restart 把状态清掉
+class Workload {
+private:
+    WorkloadSpec spec;
+    AliasTable table; // ZIPF 的页面分布，MIX 的组成部分分布
+    vector<Workload> parts; // MIX 的组成部分
+    long long position = 0; // SCAN、LOOP 下一个页面的序号；PHASES 当前阶段已经访问的次数
+    int phase_base = 0; // PHASES 当前阶段的第一个页面
+public:
+    Workload(const WorkloadSpec& spec = WorkloadSpec()) : spec(spec) {
+        if (spec.kind == WorkloadKind::ZIPF) {
+            vector<double> weights(VIRTUAL_PAGE_NUM);
+            for (int i = 0; i < VIRTUAL_PAGE_NUM; i++) {
+                weights[i] = pow(i + 1.0, -spec.exponent);
+            }
+            table = AliasTable(weights);
+        }
+        else if (spec.kind == WorkloadKind::MIX) {
+            vector<double> weights;
+            for (int i = 0; i < spec.parts.size(); i++) {
+                weights.push_back(spec.parts[i].first);
+                parts.push_back(Workload(spec.parts[i].second));
+            }
+            table = AliasTable(weights);
+        }
+        restart();
+    }
+
+    const WorkloadSpec& get_spec() const {
+        return spec;
+    }
+
+    // 回到刚构造时的状态，别名表不变
+    void restart() {
+        position = spec.kind == WorkloadKind::PHASES ? spec.phase_length : 0; // PHASES 第一次访问时开始第一个阶段
+        phase_base = 0;
+        for (int i = 0; i < parts.size(); i++) {
+            parts[i].restart();
+        }
+    }
+
+    // 下一个页面号
+    template <class G>
+    int next(G& gen) {
+        switch (spec.kind) {
+        case WorkloadKind::ZIPF:
+            return table.sample(gen());
+        case WorkloadKind::SCAN:
+            return position++ % VIRTUAL_PAGE_NUM;
+        case WorkloadKind::LOOP:
+            return position++ % spec.pages;
+        case WorkloadKind::PHASES: {
+            uint64_t r = gen();
+            if (position == spec.phase_length) {
+                position = 0;
+                phase_base = uniform_below((uint32_t)(r >> 32), VIRTUAL_PAGE_NUM);
+            }
+            position++;
+            return (phase_base + uniform_below((uint32_t)r, spec.pages)) % VIRTUAL_PAGE_NUM;
+        }
+        case WorkloadKind::MIX:
+            return parts[table.sample(gen())].next(gen);
+        }
+        return 0;
+    }
+
+    // 批量生成 n 个页面号；单一分布时分支在循环外面
+    template <class G>
+    void generate(int* pages, size_t n, G& gen) {
+        switch (spec.kind) {
+        case WorkloadKind::ZIPF:
+            for (size_t i = 0; i < n; i++) {
+                pages[i] = table.sample(gen());
+            }
+            break;
+        case WorkloadKind::SCAN:
+            for (size_t i = 0; i < n; i++) {
+                pages[i] = (position + i) % VIRTUAL_PAGE_NUM;
+            }
+            position += n;
+            break;
+        case WorkloadKind::LOOP:
+            for (size_t i = 0; i < n; i++) {
+                pages[i] = (position + i) % spec.pages;
+            }
+            position += n;
+            break;
+        default:
+            for (size_t i = 0; i < n; i++) {
+                pages[i] = next(gen);
+            }
+        }
+    }
+};
+
+// 生成一个作业的 n 次访问：逻辑地址和是否是写操作。页面号由 workload 分批生成，页内偏移和读写标记共用一个随机数
+template <class G>
+void generate_workload(Workload& workload, size_t n, vector<int>& access_list, vector<char>& write_list, G& gen) {
+    size_t base = access_list.size();
+    access_list.resize(base + n);
+    write_list.resize(base + n);
+    int* addresses = access_list.data() + base;
+    char* writes = write_list.data() + base;
+    for (size_t done = 0; done < n; done += WORKLOAD_BATCH) {
+        size_t count = min((size_t)WORKLOAD_BATCH, n - done);
+        workload.generate(addresses + done, count, gen); // 先放页面号，再原地换成地址
+        for (size_t i = done; i < done + count; i++) {
+            uint64_t r = gen();
+            addresses[i] = addresses[i] * PAGE_SIZE + uniform_below((uint32_t)r, PAGE_SIZE);
+            writes[i] = uniform_below((uint32_t)(r >> 32), 100) < WRITE_PERCENT;
+        }
+    }
+}
@@ -0,0 +1,267 @@
+#include "Simulator.h"
+#include "MyFt.h"
+
+// 性能测试，每个测试输出一行: <测试名> threads=<线程数> ops=<操作数> ns_per_op=<每次操作纳秒数>
+// 测试的顺序和名字固定，不同版本的输出可以直接 diff
+// 用法: bench [每个线程的操作数]
+
+// 测试里用的伪随机数，不依赖全局状态，每次运行的序列都一样
+struct BenchRandom {
+    uint64_t state;
+    BenchRandom(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+    uint32_t next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)(state >> 33);
+    }
+};
+
+void report(const string& name, int threads, long long ops, double ns_per_op) {
+    cout << name << " threads=" << threads << " ops=" << ops << " ns_per_op=" << fixed << setprecision(1) << ns_per_op << endl;
+}
+
+// 测试中读出的结果都累加到这里，编译器不能因为结果没人用就把被测的循环删掉
+atomic<long long> bench_sink{0};
+
+double ns_since(chrono::steady_clock::time_point start, long long ops) {
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    return ops ? elapsed.count() / ops : 0;
+}
+
+// 多个线程同时对同一个位图反复分配、释放一个作业的页框（页表 + PROCESS_PAGE_NUM 个页面）
+double bench_bitmap(BitMapMode mode, int threads, int ops) {
+    BitMap bitmap(1 << 16, mode);
+    vector<thread> workers;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&bitmap, ops] {
+            vector<int> frames;
+            frames.reserve(PROCESS_PAGE_NUM + 1);
+            for (int i = 0; i < ops; i++) {
+                frames.clear();
+                if (bitmap.allocate_pages(PROCESS_PAGE_NUM + 1, frames)) {
+                    for (int j = 0; j < frames.size(); j++) {
+                        bitmap.free_page(frames[j]);
+                    }
+                }
+            }
+        });
+    }
+    for (int t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    return ns_since(start, (long long)threads * ops);
+}
+
+// 多个线程同时读写同一个内存的随机页框，每 4 次操作有一次写
+double bench_memory(int threads, int ops) {
+    Memory memory(MEMORY_SIZE);
+    int frames = MEMORY_SIZE / PAGE_SIZE;
+    vector<thread> workers;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&memory, frames, ops, t] {
+            BenchRandom rng(t + 1);
+            long long checksum = 0;
+            for (int i = 0; i < ops; i++) {
+                int frame = rng.next() % frames;
+                if (i % 4 == 0) {
+                    memory.write_page(frame, Page(t, i));
+                }
+                else {
+                    checksum += memory.read_page(frame).get_page_id();
+                }
+            }
+            bench_sink += checksum;
+        });
+    }
+    for (int t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    return ns_since(start, (long long)threads * ops);
+}
+
+// 每个线程只读写自己的 PROCESS_PAGE_NUM + 1 个页框，和并行运行的作业一样互不相交，不应该随线程数变慢
+double bench_memory_disjoint(int threads, int ops) {
+    Memory memory((PROCESS_PAGE_NUM + 1) * threads * PAGE_SIZE);
+    vector<thread> workers;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&memory, ops, t] {
+            BenchRandom rng(t + 1);
+            int base = t * (PROCESS_PAGE_NUM + 1);
+            long long checksum = 0;
+            for (int i = 0; i < ops; i++) {
+                int frame = base + rng.next() % (PROCESS_PAGE_NUM + 1);
+                if (i % 4 == 0) {
+                    memory.write_page(frame, Page(t, i));
+                }
+                else {
+                    checksum += memory.read_page(frame).get_page_id();
+                }
+            }
+            bench_sink += checksum;
+        });
+    }
+    for (int t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    return ns_since(start, (long long)threads * ops);
+}
+
+// 不经过内存和文件，只按 Process::access 的方式驱动替换算法，返回缺页次数
+template <class Policy>
+long long drive_policy(const vector<int>& pages) {
+    Policy policy(PROCESS_PAGE_NUM, VIRTUAL_PAGE_NUM);
+    ResidentSet resident;
+    resident.page_slot.assign(VIRTUAL_PAGE_NUM, -1);
+    resident.dirty.assign(PROCESS_PAGE_NUM, 0);
+    vector<int> slot_page(PROCESS_PAGE_NUM);
+    policy.prepare(pages);
+    for (int i = 0; i < PROCESS_PAGE_NUM; i++) { // 和 allocate_memory 一样预先装入前 PROCESS_PAGE_NUM 个页面
+        resident.frames.push_back(i);
+        resident.page_slot[i] = i;
+        slot_page[i] = i;
+        policy.on_preload(i, i);
+    }
+    long long faults = 0;
+    for (int i = 0; i < pages.size(); i++) {
+        int page = pages[i];
+        int slot = resident.page_slot[page];
+        if (slot != -1) {
+            policy.on_access(page, slot);
+            continue;
+        }
+        faults++;
+        slot = policy.choose_victim(page, resident);
+        resident.page_slot[slot_page[slot]] = -1;
+        resident.page_slot[page] = slot;
+        slot_page[slot] = page;
+        policy.on_load(page, slot);
+    }
+    return faults;
+}
+
+// 每个替换算法两项：只命中的访问序列得到每次命中的开销；均匀访问所有页面的序列几乎每次缺页，得到每次缺页的开销
+template <class Policy>
+void bench_policy(int ops) {
+    vector<int> hits(ops), misses(ops);
+    BenchRandom rng(1);
+    for (int i = 0; i < ops; i++) {
+        hits[i] = rng.next() % PROCESS_PAGE_NUM;
+        misses[i] = rng.next() % VIRTUAL_PAGE_NUM;
+    }
+    auto start = chrono::steady_clock::now();
+    bench_sink += drive_policy<Policy>(hits);
+    report(string("policy.") + Policy::name() + ".hit", 1, ops, ns_since(start, ops));
+    start = chrono::steady_clock::now();
+    long long faults = drive_policy<Policy>(misses);
+    report(string("policy.") + Policy::name() + ".fault", 1, faults, ns_since(start, faults));
+}
+
+// 从作业的文件中随机读页面，也就是一次换入的开销；测试用的文件用完删掉
+double bench_file(FileFormat format, int ops) {
+    const int job_id = 1000;
+    double ns;
+    {
+        File file(job_id, format, false);
+        BenchRandom rng(1);
+        file.read_page(0); // 第一次读时校验和映射文件，不计入
+        long long checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < ops; i++) {
+            Page p = file.read_page(rng.next() % VIRTUAL_PAGE_NUM);
+            checksum += p.get_job_id() + p.get_page_id();
+        }
+        ns = ns_since(start, ops);
+        bench_sink += checksum;
+    }
+    unlink(File::file_path(job_id, format).c_str());
+    return ns;
+}
+
+// 批量生成访问序列，每个逻辑地址的开销
+double bench_workload(const string& text, int ops) {
+    WorkloadSpec spec;
+    WorkloadSpec::parse(text, spec);
+    vector<int> access_list;
+    vector<char> write_list;
+    access_list.reserve(ops);
+    write_list.reserve(ops);
+    Workload workload(spec);
+    Random gen(1);
+    auto start = chrono::steady_clock::now();
+    generate_workload(workload, ops, access_list, write_list, gen);
+    double ns = ns_since(start, ops);
+    bench_sink += access_list.back();
+    return ns;
+}
+
+// 完整运行所有作业，虚拟时间下没有休眠，得到每次模拟访问的开销；运行时的输出丢掉
+void bench_end_to_end(const string& algorithm, int workers) {
+    SimConfig config;
+    config.algorithm = algorithm;
+    config.workers = workers;
+    config.virtual_time = true;
+    Memory memory(MEMORY_SIZE);
+    Stats stats(MEMORY_SIZE / PAGE_SIZE);
+    config.stats = &stats;
+    streambuf* old = cout.rdbuf(nullptr);
+    auto start = chrono::steady_clock::now();
+    run_jobs(PROCESS_NUM, &memory, config);
+    long long accesses = stats.total().accesses;
+    double ns = ns_since(start, accesses);
+    cout.rdbuf(old);
+    cout.clear();
+    report("end_to_end." + algorithm, workers, accesses, ns);
+}
+
+// 反复运行很多个很短的作业，得到每个作业创建、运行、销毁的开销；进程对象在工作线程的对象池里复用
+void bench_job_churn(int ops) {
+    SimConfig config;
+    config.algorithm = LruPolicy::name();
+    config.workers = 1;
+    config.virtual_time = true;
+    config.accesses = 20;
+    Memory memory(MEMORY_SIZE);
+    int rounds = max(1, ops / 1000);
+    streambuf* old = cout.rdbuf(nullptr);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        run_jobs(PROCESS_NUM, &memory, config);
+    }
+    double ns = ns_since(start, (long long)rounds * PROCESS_NUM);
+    cout.rdbuf(old);
+    cout.clear();
+    report("jobs.churn", 1, (long long)rounds * PROCESS_NUM, ns);
+}
+
+int main(int argc, char* argv[]) {
+    int ops = argc > 1 ? atoi(argv[1]) : 100000;
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        report("bitmap.locked", threads, (long long)threads * ops, bench_bitmap(BitMapMode::LOCKED, threads, ops));
+        report("bitmap.lock_free", threads, (long long)threads * ops, bench_bitmap(BitMapMode::LOCK_FREE, threads, ops));
+    }
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        report("memory.read_write", threads, (long long)threads * ops, bench_memory(threads, ops));
+        report("memory.disjoint", threads, (long long)threads * ops, bench_memory_disjoint(threads, ops));
+    }
+    bench_policy<FifoPolicy>(ops);
+    bench_policy<LruPolicy>(ops);
+    bench_policy<ClockPolicy>(ops);
+    bench_policy<EnhancedClockPolicy>(ops);
+    bench_policy<ArcPolicy>(ops);
+    bench_policy<TwoQPolicy>(ops);
+    bench_policy<LirsPolicy>(ops);
+    bench_policy<OptPolicy>(ops);
+    report("file.page_in.binary", 1, ops, bench_file(FileFormat::BINARY, ops));
+    report("file.page_in.text", 1, ops, bench_file(FileFormat::TEXT, ops));
+    const char* workloads[][2] = {{"zipf", "zipf"}, {"scan", "scan"}, {"loop", "loop"}, {"phases", "phases"}, {"mix", "mix:0.8*zipf:1+0.2*scan"}};
+    for (int i = 0; i < 5; i++) {
+        report(string("workload.") + workloads[i][0], 1, ops, bench_workload(workloads[i][1], ops));
+    }
+    for (int i = 0; i < POLICIES.size(); i++) {
+        bench_end_to_end(POLICIES[i].first, 1);
+    }
+    bench_job_churn(ops);
+    return 0;
+}
@@ -0,0 +1,305 @@
+#include "Policy.h"
+#include "Mrc.h"
+#include "MyFt.h"
+
+// 正确性检查，由 ctest 运行，发现错误时输出出错的情形并返回 1
+// 用法: check [随机序列数]
+
+// 检查里用的伪随机数，每次运行的序列都一样
+struct CheckRandom {
+    uint64_t state;
+    CheckRandom(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+    int below(int n) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (int)((state >> 33) % n);
+    }
+};
+
+// 最直接的 Belady：缺页且页框已满时往后扫整个序列，淘汰下一次访问最晚的常驻页面
+int belady_faults(const vector<int>& sequence, int capacity, const vector<int>& preloaded) {
+    vector<int> resident(preloaded.begin(), preloaded.begin() + min((int)preloaded.size(), capacity));
+    int faults = 0;
+    for (int i = 0; i < sequence.size(); i++) {
+        if (find(resident.begin(), resident.end(), sequence[i]) != resident.end()) {
+            continue;
+        }
+        faults++;
+        if (resident.size() < capacity) {
+            resident.push_back(sequence[i]);
+            continue;
+        }
+        int victim = 0, farthest = -1;
+        for (int j = 0; j < resident.size(); j++) {
+            int next = i + 1;
+            while (next < sequence.size() && sequence[next] != resident[j]) {
+                next++;
+            }
+            if (next > farthest) {
+                farthest = next;
+                victim = j;
+            }
+        }
+        resident[victim] = sequence[i];
+    }
+    return faults;
+}
+
+// 最直接的 LRU：按最近访问的先后排成一列，缺页且页框已满时淘汰最后一个
+long long lru_faults(const vector<int>& sequence, int capacity) {
+    vector<int> recent; // recent[0] 是最近访问的页面
+    long long faults = 0;
+    for (int i = 0; i < sequence.size(); i++) {
+        auto it = find(recent.begin(), recent.end(), sequence[i]);
+        if (it != recent.end()) {
+            recent.erase(it);
+        }
+        else {
+            faults++;
+            if (recent.size() == capacity) {
+                recent.pop_back();
+            }
+        }
+        recent.insert(recent.begin(), sequence[i]);
+    }
+    return faults;
+}
+
+// 和 Process 一样驱动一个替换算法：先预先装入 preloaded，再按序列访问，返回缺页次数
+template <class Policy>
+int policy_faults(const vector<int>& sequence, int capacity, const vector<int>& preloaded, int keys) {
+    Policy policy(capacity, keys);
+    ResidentSet resident;
+    resident.page_slot.assign(keys, -1);
+    resident.dirty.assign(capacity, 0);
+    vector<int> slot_page(capacity, -1);
+    policy.prepare(sequence);
+    for (int i = 0; i < capacity; i++) {
+        resident.frames.push_back(i);
+        if (i < preloaded.size()) {
+            resident.page_slot[preloaded[i]] = i;
+            slot_page[i] = preloaded[i];
+            policy.on_preload(preloaded[i], i);
+        }
+    }
+    int faults = 0, used = min((int)preloaded.size(), capacity);
+    for (int i = 0; i < sequence.size(); i++) {
+        int page = sequence[i];
+        int slot = resident.page_slot[page];
+        if (slot != -1) {
+            policy.on_access(page, slot);
+            continue;
+        }
+        faults++;
+        slot = used < capacity ? used++ : policy.choose_victim(page, resident);
+        if (slot_page[slot] != -1) {
+            resident.page_slot[slot_page[slot]] = -1;
+        }
+        resident.page_slot[page] = slot;
+        slot_page[slot] = page;
+        policy.on_load(page, slot);
+    }
+    return faults;
+}
+
+void print_case(const vector<int>& sequence, int capacity, const vector<int>& preloaded) {
+    cout << "  capacity=" << capacity << " preloaded=";
+    for (int i = 0; i < preloaded.size(); i++) {
+        cout << (i ? "," : "") << preloaded[i];
+    }
+    cout << " sequence=";
+    for (int i = 0; i < sequence.size(); i++) {
+        cout << (i ? "," : "") << sequence[i];
+    }
+    cout << endl;
+}
+
+// OPT 的下界和 OPT 算法都要和暴力 Belady 的缺页次数一样；预先装入的页面经常就是第一次访问的页面
+bool check_opt(int cases) {
+    const int keys = 16, length = 60;
+    CheckRandom rng(1);
+    Opt opt;
+    int mismatches = 0;
+    for (int c = 0; c < cases; c++) {
+        int capacity = 1 + rng.below(PROCESS_PAGE_NUM);
+        vector<int> preloaded;
+        for (int i = 0; i < capacity; i++) {
+            preloaded.push_back(i); // 和 allocate_memory 一样预先装入前 capacity 个页面
+        }
+        vector<int> sequence(length);
+        for (int i = 0; i < length; i++) {
+            sequence[i] = rng.below(keys);
+        }
+        int expected = belady_faults(sequence, capacity, preloaded);
+        int bound = opt.count_faults(sequence, capacity, preloaded, keys);
+        int actual = policy_faults<OptPolicy>(sequence, capacity, preloaded, keys);
+        if (bound != expected || actual != expected) {
+            if (mismatches++ < 5) {
+                cout << "OPT mismatch: belady=" << expected << " lower_bound=" << bound << " policy=" << actual << endl;
+                print_case(sequence, capacity, preloaded);
+            }
+        }
+    }
+    cout << "opt cases=" << cases << " mismatches=" << mismatches << endl;
+    return mismatches == 0;
+}
+
+// 和动态分配一样随机地扩大、缩小、挂起常驻集合，替换算法选出的槽位必须是当前槽位中装着页面的一个
+template <class Policy>
+bool check_resize(int cases) {
+    const int keys = 32, steps = 200;
+    CheckRandom rng(2);
+    int failures = 0;
+    for (int c = 0; c < cases && failures == 0; c++) {
+        int n = MIN_PROCESS_PAGE_NUM;
+        Policy policy(n, keys);
+        policy.prepare(vector<int>());
+        ResidentSet resident;
+        resident.page_slot.assign(keys, -1);
+        resident.frames.resize(n);
+        resident.dirty.assign(n, 0);
+        vector<int> slot_page(n, -1);
+        auto remove = [&](int slot) {
+            policy.on_remove(slot_page[slot], slot);
+            resident.page_slot[slot_page[slot]] = -1;
+            slot_page[slot] = -1;
+            resident.dirty[slot] = 0;
+        };
+        for (int step = 0; step < steps && failures == 0; step++) {
+            int action = rng.below(10);
+            if (action == 0 && n < MAX_PROCESS_PAGE_NUM) { // 扩大，新槽位空着
+                n++;
+                resident.frames.resize(n);
+                resident.dirty.push_back(0);
+                slot_page.push_back(-1);
+                policy.resize(n);
+            }
+            else if (action == 1 && n > MIN_PROCESS_PAGE_NUM) { // 缩小，和 shrink 一样把最后一个槽位挪到空出来的位置
+                int slot = find(slot_page.begin(), slot_page.end(), -1) - slot_page.begin();
+                if (slot == n) {
+                    slot = rng.below(n);
+                    remove(slot);
+                }
+                int last = n - 1;
+                if (slot != last && slot_page[last] != -1) {
+                    slot_page[slot] = slot_page[last];
+                    resident.dirty[slot] = resident.dirty[last];
+                    resident.page_slot[slot_page[slot]] = slot;
+                    policy.on_move(slot_page[slot], last, slot);
+                }
+                n--;
+                resident.frames.resize(n);
+                resident.dirty.resize(n);
+                slot_page.resize(n);
+                policy.resize(n);
+            }
+            else if (action == 2 && rng.below(10) == 0) { // 挂起，全部换出后按新的槽位数回来
+                for (int slot = 0; slot < n; slot++) {
+                    if (slot_page[slot] != -1) {
+                        remove(slot);
+                    }
+                }
+                n = MIN_PROCESS_PAGE_NUM + rng.below(MAX_PROCESS_PAGE_NUM - MIN_PROCESS_PAGE_NUM + 1);
+                resident.frames.resize(n);
+                resident.dirty.assign(n, 0);
+                slot_page.assign(n, -1);
+                policy.resize(n);
+            }
+            else { // 访问
+                int page = rng.below(keys);
+                int slot = resident.page_slot[page];
+                if (slot != -1) {
+                    policy.on_access(page, slot);
+                }
+                else {
+                    slot = find(slot_page.begin(), slot_page.end(), -1) - slot_page.begin();
+                    if (slot == n) {
+                        slot = policy.choose_victim(page, resident);
+                        if (slot < 0 || slot >= n || slot_page[slot] == -1) {
+                            cout << Policy::name() << " chose slot " << slot << " of " << n << " slots in case " << c << " step " << step << endl;
+                            failures++;
+                            break;
+                        }
+                        resident.page_slot[slot_page[slot]] = -1;
+                    }
+                    resident.dirty[slot] = 0;
+                    resident.page_slot[page] = slot;
+                    slot_page[slot] = page;
+                    policy.on_load(page, slot);
+                }
+                if (rng.below(4) == 0) {
+                    resident.dirty[slot] = 1;
+                }
+            }
+        }
+    }
+    cout << "resize." << Policy::name() << " cases=" << cases << " failures=" << failures << endl;
+    return failures == 0;
+}
+
+// 栈距离算出的每个页框数下的缺页次数，必须和直接模拟 LRU 的一样；misses 和 curve 两种算法都检查
+bool check_mrc(int cases) {
+    const int keys = 32, length = 300;
+    CheckRandom rng(4);
+    int mismatches = 0;
+    for (int c = 0; c < cases / 10 && mismatches == 0; c++) {
+        StackDistances distances(keys);
+        vector<int> sequence(length);
+        for (int i = 0; i < length; i++) {
+            sequence[i] = rng.below(1 + c % keys);
+            distances.access(sequence[i]);
+        }
+        vector<long long> curve = distances.curve(keys + 1);
+        for (int frames = 1; frames <= keys + 1; frames++) {
+            long long expected = lru_faults(sequence, frames);
+            if (distances.misses(frames) != expected || curve[frames] != expected) {
+                cout << "MRC mismatch: case " << c << " frames=" << frames << " lru=" << expected << " misses=" << distances.misses(frames) << " curve=" << curve[frames] << endl;
+                mismatches++;
+                break;
+            }
+        }
+    }
+    cout << "mrc cases=" << cases / 10 << " mismatches=" << mismatches << endl;
+    return mismatches == 0;
+}
+
+// 抽样率为 1 时所有页面都被抽中，SHARDS 的估计必须和精确的栈距离曲线完全一样
+bool check_shards(int cases) {
+    const int keys = 64, length = 500;
+    CheckRandom rng(3);
+    int mismatches = 0;
+    for (int c = 0; c < cases / 10 && mismatches == 0; c++) {
+        StackDistances exact(keys);
+        ShardsMrc shards(1.0, keys);
+        for (int i = 0; i < length; i++) {
+            int page = rng.below(1 + c % keys);
+            exact.access(page);
+            shards.access(page);
+        }
+        for (int frames = 1; frames <= keys + 1; frames++) {
+            double expected = (double)exact.misses(frames) / exact.accesses();
+            double estimate = shards.miss_ratio(frames);
+            if (fabs(estimate - expected) > 1e-9) {
+                cout << "SHARDS mismatch: case " << c << " frames=" << frames << " exact=" << expected << " shards=" << estimate << endl;
+                mismatches++;
+                break;
+            }
+        }
+    }
+    cout << "shards cases=" << cases / 10 << " mismatches=" << mismatches << endl;
+    return mismatches == 0;
+}
+
+int main(int argc, char* argv[]) {
+    int cases = argc > 1 ? atoi(argv[1]) : 2000;
+    bool ok = check_opt(cases);
+    ok = check_resize<FifoPolicy>(cases) && ok;
+    ok = check_resize<LruPolicy>(cases) && ok;
+    ok = check_resize<ClockPolicy>(cases) && ok;
+    ok = check_resize<EnhancedClockPolicy>(cases) && ok;
+    ok = check_resize<ArcPolicy>(cases) && ok;
+    ok = check_resize<TwoQPolicy>(cases) && ok;
+    ok = check_resize<LirsPolicy>(cases) && ok; // OPT 要事先知道访问序列，只用于固定分配
+    ok = check_mrc(cases) && ok;
+    ok = check_shards(cases) && ok;
+    return ok ? 0 : 1;
+}
@@ -1,13 +1,206 @@
-#include "MyFT.cpp"
+#include "Simulator.h"
 #include "MyFt.h"
 
 // 主函数，测试代码
-int main() {
-    Memory* memory = new Memory(MEMORY_SIZE); // 创建内存对象
-    string algorithm; 
-    cout << "请输入替换算法名称 (FIFO or LRU): " << endl; 
-    cin >> algorithm; 
-    run_jobs(PROCESS_NUM, memory, algorithm); 
+// 用法: main [FIFO|LRU|CLOCK|ECLOCK|ARC|2Q|LIRS|OPT] [-j 工作线程数] [--lock-free] [--text-files] [--trace 轨迹文件前缀] [--virtual-time]
+//            [--log off|faults|all] [--log-file 文件] [--log-binary]
+//            [--stats-json 文件] [--stats-csv 文件] [--occupancy-csv 文件] [--global]
+//            [--alloc fixed|ws|pff] [--workload 访问分布] [--accesses 每个作业的访问次数] [--seed 随机种子]
+//       main --mrc [--trace 轨迹文件前缀]   只分析每个作业的访问序列，输出 LRU 在每个页框数下的缺页次数
+//       main --shards 抽样率(0, 1] [--shards-pages 页面数] [--trace 轨迹文件前缀]   抽样估计缺页率曲线，给很大的轨迹用
+//       main --import   把已有的 file_N.txt 转换成二进制的 file_N.bin
+//       main --convert-trace 输入 输出   把轨迹文件转换成二进制格式
+int main(int argc, char* argv[]) {
+    SimConfig config;
+    config.workers = thread::hardware_concurrency(); // 默认每个核一个工作线程
+    LogLevel log_level = LogLevel::ALL;
+    string log_file; // 为空时写到标准输出
+    bool log_binary = false;
+    bool mrc = false; // 分析模式，不运行作业
+    double shards_rate = 0; // 给出 --shards 时用 SHARDS 抽样分析，否则为 0
+    int shards_pages = SHARDS_MAX_PAGES;
+    bool seeded = false; // 命令行给出了种子
+    string stats_json, stats_csv, occupancy_csv; // 统计导出的文件，为空时不导出
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "-j" || arg == "--workers") && i + 1 < argc) {
+            char* stop;
+            long workers = strtol(argv[++i], &stop, 10);
+            if (*argv[i] == '\0' || *stop != '\0' || workers < 1 || workers > INT_MAX) {
+                cout << "Invalid number of workers: " << argv[i] << endl;
+                return 1;
+            }
+            config.workers = workers;
+        }
+        else if (arg == "--lock-free") {
+            config.bitmap_mode = BitMapMode::LOCK_FREE;
+        }
+        else if (arg == "--text-files") {
+            config.file_format = FileFormat::TEXT;
+        }
+        else if (arg == "--log" && i + 1 < argc) {
+            if (!Logger::parse_level(argv[++i], log_level)) {
+                cout << "Unknown log level: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--log-file" && i + 1 < argc) {
+            log_file = argv[++i];
+        }
+        else if (arg == "--log-binary") {
+            log_binary = true;
+        }
+        else if (arg == "--stats-json" && i + 1 < argc) {
+            stats_json = argv[++i];
+        }
+        else if (arg == "--stats-csv" && i + 1 < argc) {
+            stats_csv = argv[++i];
+        }
+        else if (arg == "--occupancy-csv" && i + 1 < argc) {
+            occupancy_csv = argv[++i];
+        }
+        else if (arg == "--alloc" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "fixed") {
+                config.allocation = AllocMode::FIXED;
+            }
+            else if (mode == "ws") {
+                config.allocation = AllocMode::WORKING_SET;
+            }
+            else if (mode == "pff") {
+                config.allocation = AllocMode::PFF;
+            }
+            else {
+                cout << "Unknown allocation mode: " << mode << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--workload" && i + 1 < argc) {
+            if (!WorkloadSpec::parse(argv[++i], config.workload)) {
+                cout << "Unknown workload: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--accesses" && i + 1 < argc) {
+            config.accesses = atoll(argv[++i]);
+            if (config.accesses < 0 || config.accesses > INT_MAX) {
+                cout << "Invalid number of accesses: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            char* stop;
+            config.seed = strtoull(argv[++i], &stop, 10);
+            if (*argv[i] == '\0' || *stop != '\0') {
+                cout << "Invalid seed: " << argv[i] << endl;
+                return 1;
+            }
+            seeded = true;
+        }
+        else if (arg == "--mrc") {
+            mrc = true;
+        }
+        else if (arg == "--shards" && i + 1 < argc) {
+            char* stop;
+            shards_rate = strtod(argv[++i], &stop);
+            if (*argv[i] == '\0' || *stop != '\0' || !(shards_rate > 0 && shards_rate <= 1)) { // 抽样率在 (0, 1] 之间
+                cout << "Invalid sampling rate: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--shards-pages" && i + 1 < argc) {
+            char* stop;
+            long pages = strtol(argv[++i], &stop, 10);
+            if (*argv[i] == '\0' || *stop != '\0' || pages < 1 || pages > INT_MAX) {
+                cout << "Invalid number of sampled pages: " << argv[i] << endl;
+                return 1;
+            }
+            shards_pages = pages;
+        }
+        else if (arg == "--global") {
+            config.global_replacement = true;
+        }
+        else if (arg == "--virtual-time") {
+            config.virtual_time = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            config.trace_prefix = argv[++i];
+        }
+        else if (arg == "--import") {
+            for (int job = 0; job < PROCESS_NUM; job++) {
+                if (File::import_text(job)) {
+                    cout << "Imported " << File::file_path(job, FileFormat::TEXT) << " into " << File::file_path(job, FileFormat::BINARY) << endl;
+                }
+            }
+            return 0;
+        }
+        else if (arg == "--convert-trace" && i + 2 < argc) {
+            if (!TraceWriter::convert(argv[i + 1], argv[i + 2])) {
+                cout << "Failed to convert " << argv[i + 1] << " into " << argv[i + 2] << endl;
+                return 1;
+            }
+            return 0;
+        }
+        else {
+            config.algorithm = arg;
+        }
+    }
+    if (!seeded) {
+        config.seed = random_seed();
+    }
+    // 加上 --seed 重现这次运行；分析模式也用种子生成访问序列，它们的输出是 CSV，种子写成注释行
+    cout << (shards_rate > 0 || mrc ? "# " : "") << "Random seed: " << config.seed << endl;
+    if (shards_rate > 0) {
+        run_shards(PROCESS_NUM, config, shards_rate, shards_pages, cout);
+        return 0;
+    }
+    if (mrc) {
+        run_mrc(PROCESS_NUM, config, cout);
+        return 0;
+    }
+    if (config.algorithm.empty()) {
+        cout << "请输入替换算法名称 (FIFO, LRU, CLOCK, ECLOCK, ARC, 2Q, LIRS or OPT): " << endl; 
+        cin >> config.algorithm; 
+    }
+    if (!valid_algorithm(config.algorithm)) {
+        cout << "Unknown replacement algorithm: " << config.algorithm << endl;
+        return 1;
+    }
+    if (config.algorithm == OptPolicy::name() && !config.trace_prefix.empty()) {
+        cout << "OPT needs the whole access sequence in advance and cannot stream a trace." << endl;
+        return 1;
+    }
+    if (config.algorithm == OptPolicy::name() && config.global_replacement) {
+        cout << "OPT needs each job's whole access sequence and cannot replace pages across jobs." << endl;
+        return 1;
+    }
+    if (config.allocation != AllocMode::FIXED && config.algorithm == OptPolicy::name()) {
+        cout << "OPT cannot be rebuilt when the resident set is resized." << endl;
+        return 1;
+    }
+    if (config.allocation != AllocMode::FIXED && config.global_replacement) {
+        cout << "Dynamic allocation sizes each job's own frames and cannot be combined with --global." << endl;
+        return 1;
+    }
+    Memory* memory = new Memory(MEMORY_SIZE, config.bitmap_mode); // 创建内存对象
+    Logger* logger = new Logger(log_level, log_file, log_binary);
+    config.logger = logger;
+    Stats stats(MEMORY_SIZE / PAGE_SIZE);
+    config.stats = &stats;
+    run_jobs(PROCESS_NUM, memory, config); 
+    delete logger; // 写完剩下的日志
+    if (!stats_json.empty() && !stats.write_json(stats_json)) {
+        cout << "Failed to write " << stats_json << endl;
+    }
+    if (!stats_csv.empty() && !stats.write_csv(stats_csv)) {
+        cout << "Failed to write " << stats_csv << endl;
+    }
+    if (!occupancy_csv.empty() && !stats.write_occupancy_csv(occupancy_csv)) {
+        cout << "Failed to write " << occupancy_csv << endl;
+    }
+    if (config.virtual_time) {
+        cout << "All jobs finished at virtual time " << memory->get_last_release() << " ms." << endl;
+    }
     delete memory; // 释放内存
     return 0;
-}
\ No newline at end of file
+}